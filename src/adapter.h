@@ -0,0 +1,135 @@
+#ifndef SCROLLER_ADAPTER_H
+#define SCROLLER_ADAPTER_H
+
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common.h"
+#include "enums.h"
+#include "events.h"
+
+// The layout core (Row, Column, Window, ScrollerSizes) doesn't know about
+// Hyprland. Everything it needs from the compositor goes through these
+// adapters. The plugin implements them on top of Hyprland (hyprland.h), and
+// the headless tools implement them with a mock that records geometry.
+
+typedef int64_t WorkspaceID;
+typedef int64_t MonitorID;
+typedef uint64_t WindowID;
+
+class ScrollerSizes;
+
+enum class FullscreenMode { None, Maximized, Fullscreen };
+
+// Space reserved around a window (borders, decorations)
+struct Extents {
+    Vector2D top_left;
+    Vector2D bottom_right;
+};
+
+// Usable geometry of a workspace on its monitor
+struct Viewport {
+    Box full;       // whole monitor
+    Box max;        // monitor minus reserved areas and gaps_out
+    int gap;        // gaps_in
+};
+
+// Configuration values the core reads
+struct LayoutConfig {
+    bool center_row_if_space_available = false;
+    bool center_active_column = false;
+    bool center_active_window = false;
+    bool cyclesize_closest = true;
+    bool overview_scale_content = true;
+
+    bool operator==(const LayoutConfig &) const = default;
+};
+
+class WindowAdapter {
+public:
+    virtual ~WindowAdapter() {}
+
+    // Stable identifier, used to find the window in the layout
+    virtual WindowID get_id() const = 0;
+    virtual const std::string &get_monitor_name() const = 0;
+    // Arguments of the "plugin:scroller:<name>" window rules matching this window
+    virtual std::vector<std::string> get_rules(const std::string &name) const = 0;
+
+    // Layout geometry. Changes are only visible after a commit.
+    virtual Extents get_reserved_area() const = 0;
+    virtual const Vector2D &get_position() const = 0;
+    virtual void set_position(const Vector2D &position) = 0;
+    virtual const Vector2D &get_size() const = 0;
+    virtual void set_size(const Vector2D &size) = 0;
+    // Apply position and size, and send the new size to the client. Does
+    // nothing and returns false if they are the ones already applied.
+    virtual bool commit(bool animate) = 0;
+    // Apply only the position
+    virtual void commit_position(bool animate) = 0;
+
+    virtual FullscreenMode get_fullscreen_mode() const = 0;
+    // Sets mode, or back to FullscreenMode::None if already in a fullscreen mode
+    virtual void toggle_fullscreen(FullscreenMode mode) = 0;
+
+    virtual void set_selected(bool selected) = 0;
+    // Schedule a redraw of the window's current box, with its borders and
+    // decorations
+    virtual void damage() = 0;
+    virtual void pin(bool pin) = 0;
+    virtual void move_to_workspace(WorkspaceID workspace) = 0;
+    virtual void set_no_initial_focus() = 0;
+
+    virtual void focus() = 0;
+    // Focus, warp the cursor and make the input manager follow
+    virtual void force_focus() = 0;
+    virtual void warp_cursor() = 0;
+    virtual void update_relative_cursor_coords() = 0;
+};
+
+class LayoutAdapter {
+public:
+    virtual ~LayoutAdapter() {}
+
+    virtual const LayoutConfig &get_config() = 0;
+    // Window and column sizes, up to date with the configuration
+    virtual ScrollerSizes &get_sizes() = 0;
+
+    virtual MonitorID get_active_monitor() const = 0;
+    virtual const std::string &get_monitor_name(MonitorID monitor) const = 0;
+    virtual Viewport get_viewport(MonitorID monitor, WorkspaceID workspace) const = 0;
+    // Monitor workspace is on, the active one if it isn't on any
+    virtual MonitorID get_workspace_monitor(WorkspaceID workspace) const = 0;
+    // Shown on its monitor, as its regular or special workspace
+    virtual bool is_workspace_visible(WorkspaceID workspace) const = 0;
+    virtual bool has_monitor_in_direction(Direction direction) const = 0;
+    // Default movefocus behavior: focus the monitor in that direction
+    virtual void focus_monitor_in_direction(Direction direction) = 0;
+    virtual Vector2D get_mouse_coords() const = 0;
+    // Schedule a redraw of the monitor showing workspace
+    virtual void damage_workspace(WorkspaceID workspace) = 0;
+
+    // Overview with scaled content. enable returns false if not available.
+    virtual bool overview_enable(WorkspaceID workspace) = 0;
+    virtual void overview_set_scale(WorkspaceID workspace, double scale) = 0;
+    virtual void overview_disable(WorkspaceID workspace) = 0;
+
+    // IPC event, "data" part of a "scroller" event. Adapters queue it in an
+    // EventBus and flush it at the end of the event loop iteration.
+    virtual void post_event(EventTopic topic, std::string_view data) = 0;
+    // Formats the event in a stack buffer, so posting it doesn't allocate.
+    // Only events that don't fit (long mark names) are formatted on the heap.
+    template <typename... Args>
+    void post_formatted_event(EventTopic topic, std::format_string<const Args &...> fmt, const Args &...args) {
+        char buffer[128];
+        const auto result = std::format_to_n(buffer, sizeof(buffer), fmt, args...);
+        if (result.size <= static_cast<std::ptrdiff_t>(sizeof(buffer)))
+            post_event(topic, std::string_view(buffer, result.size));
+        else
+            post_event(topic, std::format(fmt, args...));
+    }
+};
+
+#endif // SCROLLER_ADAPTER_H
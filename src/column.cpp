@@ -1,20 +1,16 @@
+#include <cmath>
+
 #include "sizes.h"
 #include "column.h"
 #include "row.h"
 
-#include <hyprland/src/config/ConfigManager.hpp>
-#include <hyprland/src/plugins/PluginAPI.hpp>
-
-extern HANDLE PHANDLE;
-extern std::function<SDispatchResult(std::string)> orig_moveFocusTo;
-extern ScrollerSizes scroller_sizes;
-
-Column::Column(PHLWINDOW cwindow, const Row *row)
+Column::Column(WindowAdapter *cwindow, const Row *row)
     : reorder(Reorder::Auto), row(row)
 {
-    width = scroller_sizes.get_column_default_width(cwindow);
+    const ScrollerSizes &sizes = row->get_adapter()->get_sizes();
+    width = sizes.get_column_default_width(cwindow);
     const Box &max = row->get_max();
-    Window *window = new Window(cwindow, max.y, max.h, width);
+    Window *window = new Window(cwindow, sizes.get_window_default_height(cwindow), max.y, max.h, width);
     windows.push_back(window);
     active = windows.first();
     update_width(width, max.w);
@@ -32,7 +28,6 @@ Column::Column(PHLWINDOW cwindow, const Row *row)
 Column::Column(Window *window, StandardSize width, double maxw, const Row *row)
     : width(width), reorder(Reorder::Auto), row(row)
 {
-    const Box &max = row->get_max();
     windows.push_back(window);
     active = windows.first();
     update_width(width, maxw);
@@ -52,6 +47,28 @@ Column::Column(const Row *pRow, const Column *column, List<Window *> &pWindows)
     row = pRow;
 }
 
+Column::Column(const Row *row, const SnapshotColumn &saved,
+               const std::vector<std::pair<WindowAdapter *, const SnapshotWindow *>> &windows)
+    : reorder(Reorder::Auto), active(nullptr), name(saved.name), row(row)
+{
+    const Box &max = row->get_max();
+    for (size_t i = 0; i < windows.size(); ++i) {
+        const SnapshotWindow *swindow = windows[i].second;
+        Window *window = new Window(windows[i].first, swindow->height, max.y, max.h, swindow->width);
+        // Invalid free sizes take the whole viewport
+        if (swindow->height == StandardSize::Free)
+            window->set_geom_h(std::isfinite(swindow->h) && swindow->h > 0.0 ? swindow->h : max.h);
+        auto node = this->windows.emplace_after(this->windows.last(), window);
+        if (active == nullptr || &saved.windows[saved.active] == swindow)
+            active = node;
+    }
+    update_width(saved.width, max.w, false);
+    if (saved.width == StandardSize::Free && std::isfinite(saved.w) && saved.w > 0.0)
+        geom.w = saved.w;
+    geom.x = max.x;
+    geom.vy = max.y;
+}
+
 Column::~Column()
 {
     for (auto win = windows.first(); win != nullptr; win = win->next()) {
@@ -60,7 +77,7 @@ Column::~Column()
     windows.clear();
 }
 
-bool Column::has_window(PHLWINDOW window) const
+bool Column::has_window(WindowID window) const
 {
     for (auto win = windows.first(); win != nullptr; win = win->next()) {
         if (win->data()->is_window(window))
@@ -69,7 +86,7 @@ bool Column::has_window(PHLWINDOW window) const
     return false;
 }
 
-Window *Column::get_window(PHLWINDOW window) const
+Window *Column::get_window(WindowID window) const
 {
     for (auto win = windows.first(); win != nullptr; win = win->next()) {
         if (win->data()->is_window(window))
@@ -78,17 +95,21 @@ Window *Column::get_window(PHLWINDOW window) const
     return nullptr;
 }
 
-void Column::add_active_window(PHLWINDOW window)
+void Column::add_active_window(WindowAdapter *window)
 {
-    reorder = Reorder::Auto;
+    const ScrollerSizes &sizes = row->get_adapter()->get_sizes();
     // Store the default window width internally, regardless of that of the column
-    auto wwidth = scroller_sizes.get_column_default_width(window);
-    auto w = new Window(window, row->get_max().y, row->get_max().h, wwidth);
+    auto wwidth = sizes.get_column_default_width(window);
+    insert_active_window(new Window(window, sizes.get_window_default_height(window), row->get_max().y, row->get_max().h, wwidth));
+}
 
+void Column::insert_active_window(Window *w)
+{
+    reorder = Reorder::Auto;
     if (row->get_pinned_column() == this)
         w->pin(true);
 
-    ModeModifier modifier = row->get_mode_modifier();
+    const ModeModifier &modifier = row->get_mode_modifier();
     auto focus = modifier.get_focus();
     auto node = active;
     switch (modifier.get_position()) {
@@ -109,10 +130,15 @@ void Column::add_active_window(PHLWINDOW window)
     if (focus == ModeModifier::FOCUS_FOCUS)
         active = node;
     else
-        window->m_bNoInitialFocus = true;
+        w->get_window()->set_no_initial_focus();
+}
+
+void Column::remove_window(WindowID window)
+{
+    delete take_window(window);
 }
 
-void Column::remove_window(PHLWINDOW window)
+Window *Column::take_window(WindowID window)
 {
     reorder = Reorder::Auto;
     for (auto win = windows.first(); win != nullptr; win = win->next()) {
@@ -125,16 +151,17 @@ void Column::remove_window(PHLWINDOW window)
                 // the column.
                 active = active != windows.last() ? active->next() : active->prev();
             }
+            Window *taken = win->data();
             if (row->get_pinned_column() == this)
-                win->data()->pin(false);
+                taken->pin(false);
             windows.erase(win);
-            delete win->data();
-            return;
+            return taken;
         }
     }
+    return nullptr;
 }
 
-void Column::focus_window(PHLWINDOW window)
+void Column::focus_window(WindowID window)
 {
     for (auto win = windows.first(); win != nullptr; win = win->next()) {
         if (win->data()->is_window(window)) {
@@ -162,7 +189,7 @@ void Column::recalculate_col_geometry(const Vector2D &gap_x, double gap, bool an
     auto a_y0 = std::round(active->data()->get_geom_y(gap0));
     auto a_y1 = std::round(a_y0 + active->data()->get_geom_h());
 
-    if (row->get_mode_modifier().get_center_window().value() && row->get_active_column() == this) {
+    if (row->get_center_window() && row->get_active_column() == this) {
         double start = max.y + 0.5 * (max.h - (a_y1 - a_y0));
         active->data()->move_to_pos(geom.x, start, gap_x, gap0);
         adjust_windows(active, gap_x, gap, animate);
@@ -296,14 +323,14 @@ void Column::move_active_down()
 bool Column::move_focus_up(bool focus_wrap)
 {
     if (active == windows.first()) {
-        PHLMONITOR monitor = g_pCompositor->getMonitorInDirection('u');
-        if (monitor == nullptr) {
+        LayoutAdapter *adapter = row->get_adapter();
+        if (!adapter->has_monitor_in_direction(Direction::Up)) {
             if (focus_wrap)
                 active = windows.last();
             return true;
         }
         // use default dispatch for movefocus (change monitor)
-        orig_moveFocusTo("u");
+        adapter->focus_monitor_in_direction(Direction::Up);
         return false;
     }
     reorder = Reorder::Auto;
@@ -314,14 +341,14 @@ bool Column::move_focus_up(bool focus_wrap)
 bool Column::move_focus_down(bool focus_wrap)
 {
     if (active == windows.last()) {
-        PHLMONITOR monitor = g_pCompositor->getMonitorInDirection('d');
-        if (monitor == nullptr) {
+        LayoutAdapter *adapter = row->get_adapter();
+        if (!adapter->has_monitor_in_direction(Direction::Down)) {
             if (focus_wrap)
                 active = windows.first();
             return true;
         }
         // use default dispatch for movefocus (change monitor)
-        orig_moveFocusTo("d");
+        adapter->focus_monitor_in_direction(Direction::Down);
         return false;
     }
     reorder = Reorder::Auto;
@@ -513,19 +540,21 @@ void Column::fit_size(FitSize fitsize, const Vector2D &gap_x, double gap)
 void Column::cycle_size_active_window(int step, const Vector2D &gap_x, double gap)
 {
     reorder = Reorder::Auto;
+    LayoutAdapter *adapter = row->get_adapter();
+    const ScrollerSizes &sizes = adapter->get_sizes();
+    const std::string &monitor = adapter->get_monitor_name(adapter->get_active_monitor());
     StandardSize height = active->data()->get_height();
     if (height == StandardSize::Free) {
 
         // When cycle-resizing from Free mode, move back to closest or default
-        static auto* const *CYCLESIZE_CLOSEST = (Hyprlang::INT* const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:cyclesize_closest")->getDataStaticPtr();
-        if (**CYCLESIZE_CLOSEST) {
+        if (adapter->get_config().cyclesize_closest) {
             double fraction = active->data()->get_geom_h() / row->get_max().h;
-            height = scroller_sizes.get_window_closest_height(g_pCompositor->m_pLastMonitor, fraction, step);
+            height = sizes.get_window_closest_height(monitor, fraction, step);
         } else {
-            height = scroller_sizes.get_window_default_height(active->data()->get_window());
+            height = sizes.get_window_default_height(active->data()->get_window());
         }
     } else {
-        height = scroller_sizes.get_next_window_height(height, step);
+        height = sizes.get_next_window_height(monitor, height, step);
     }
     active->data()->update_height(height, row->get_max().h);
     recalculate_col_geometry(gap_x, gap, true);
@@ -638,10 +667,10 @@ void Column::selection_toggle()
     active->data()->selection_toggle();
 }
 
-void Column::selection_set(PHLWINDOWREF window)
+void Column::selection_set(WindowID window)
 {
     for (auto w = windows.first(); w != nullptr; w = w->next()) {
-        if (w->data()->get_window() == window) {
+        if (w->data()->is_window(window)) {
             w->data()->selection_set();
             return;
         }
@@ -676,7 +705,7 @@ Column *Column::selection_get(const Row *row)
     Column *column = nullptr;
     List<Window *> selection;
     ListNode<Window *> *win = windows.first();
-    PHLWORKSPACE workspace = g_pCompositor->getWorkspaceByID(row->get_workspace());
+    WorkspaceID workspace = row->get_workspace();
     while (win != nullptr) {
         auto next = win->next();
         if (win->data()->is_selected()) {
@@ -702,3 +731,37 @@ void Column::pin(bool pin) const
     }
 }
 
+void Column::save(SnapshotColumn &column, bool overview) const
+{
+    // Standard sizes are recalculated for the viewport they are restored in
+    column.width = width;
+    column.w = width == StandardSize::Free ? (overview ? mem.geom.w : geom.w) : 0.0;
+    column.name = name;
+    column.active = 0;
+    column.windows.clear();
+    for (auto win = windows.first(); win != nullptr; win = win->next()) {
+        if (win == active)
+            column.active = column.windows.size();
+        const Window *window = win->data();
+        const StandardSize height = window->get_height();
+        const double h = height == StandardSize::Free ? window->get_geom_h(overview) : 0.0;
+        column.windows.push_back({ { window->get_id(), {}, {} }, height, window->get_width(), h });
+    }
+}
+
+std::string Column::check(const Row *owner) const
+{
+    if (row != owner)
+        return "column belongs to another row";
+    if (!windows.is_valid())
+        return "broken window list";
+    if (windows.empty())
+        return "empty column";
+    if (!windows.contains(active))
+        return "active is not a window of the column";
+    for (auto win = windows.first(); win != nullptr; win = win->next()) {
+        if (win->data() == nullptr || win->data()->get_window() == nullptr)
+            return "window without adapter";
+    }
+    return "";
+}
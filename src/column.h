@@ -1,33 +1,46 @@
 #ifndef SCROLLER_COLUMN_H
 #define SCROLLER_COLUMN_H
 
+#include <string>
+#include <vector>
+
 #include "list.h"
 #include "common.h"
+#include "snapshot.h"
 #include "window.h"
 
 class Row;
 
 class Column {
 public:
-    Column(PHLWINDOW cwindow, const Row *row);
+    Column(WindowAdapter *cwindow, const Row *row);
     Column(Window *window, StandardSize width, double maxw, const Row *row);
     Column(const Row *row, const Column *column, List<Window *> &windows);
+    // Restores a column from a snapshot, with the windows of saved that are
+    // still around (not empty), in saved's order
+    Column(const Row *row, const SnapshotColumn &saved,
+           const std::vector<std::pair<WindowAdapter *, const SnapshotWindow *>> &windows);
     ~Column();
     std::string get_name() const { return name; }
     void set_name (const std::string &str) { name = str; }
     size_t size() const {
         return windows.size();
     }
-    void get_windows(std::vector<PHLWINDOWREF> &pWindows) {
+    void get_windows(std::vector<WindowAdapter *> &pWindows) {
         for (auto win = windows.first(); win != nullptr; win = win->next()) {
             pWindows.push_back(win->data()->get_window());
         }
     }
-    bool has_window(PHLWINDOW window) const;
-    Window *get_window(PHLWINDOW window) const;
-    void add_active_window(PHLWINDOW window);
-    void remove_window(PHLWINDOW window);
-    void focus_window(PHLWINDOW window);
+    bool has_window(WindowID window) const;
+    Window *get_window(WindowID window) const;
+    void add_active_window(WindowAdapter *window);
+    // Inserts a window taken from another column, keeping its sizes and state
+    void insert_active_window(Window *window);
+    void remove_window(WindowID window);
+    // Takes window out of the column without deleting it, nullptr if it isn't
+    // in the column
+    Window *take_window(WindowID window);
+    void focus_window(WindowID window);
     double get_geom_x() const {
         return geom.x;
     }
@@ -73,10 +86,10 @@ public:
         active->data()->set_geometry(box);
     }
     bool fullscreen() const {
-        return active->data()->fullscreen_state() != eFullscreenMode::FSMODE_NONE;
+        return active->data()->fullscreen_state() != FullscreenMode::None;
     }
     bool maximized() const {
-        return active->data()->fullscreen_state() == eFullscreenMode::FSMODE_MAXIMIZED;
+        return active->data()->fullscreen_state() == FullscreenMode::Maximized;
     }
     // Used by auto-centering of columns
     void set_geom_pos(double x, double vy) {
@@ -87,7 +100,7 @@ public:
     void recalculate_col_geometry(const Vector2D &gap_x, double gap, bool animate);
     // Recalculates the geometry of the windows in the column for overview mode
     void recalculate_col_geometry_overview(const Vector2D &gap_x, double gap);
-    PHLWINDOW get_active_window() {
+    WindowAdapter *get_active_window() {
         return active->data()->get_window();
     }
     void move_active_up();
@@ -113,7 +126,7 @@ public:
     void size_active_window(StandardSize height, const Vector2D &gap_x, double gap);
     void resize_active_window(const Vector2D &gap_x, double gap, const Vector2D &delta);
     void selection_toggle();
-    void selection_set(PHLWINDOWREF window);
+    void selection_set(WindowID window);
     void selection_all();
     void selection_reset();
     Column *selection_get(const Row *row);
@@ -121,6 +134,11 @@ public:
     void pin(bool pin) const;
     void scroll_update(double delta_y);
     void scroll_end(Direction dir, double gap);
+    // overview is true if the row is in overview mode, sizes are saved
+    // without its scaling
+    void save(SnapshotColumn &column, bool overview) const;
+    // Structural checks for the headless tools: empty if consistent
+    std::string check(const Row *owner) const;
 
 private:
     // Adjust all the windows in the column using 'window' as anchor
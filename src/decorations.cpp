@@ -7,14 +7,13 @@
 #include <hyprland/src/render/pass/TexPassElement.hpp>
 
 #include "decorations.h"
-#include "window.h"
-
-#include <pango/pangocairo.h>
+#include "hyprland.h"
+#include "labels.h"
 
 extern HANDLE PHANDLE;
 
 // SelectionBorders
-SelectionBorders::SelectionBorders(Window *window) : IHyprWindowDecoration(window->get_window()), window(window) {
+SelectionBorders::SelectionBorders(HyprlandWindow *window) : IHyprWindowDecoration(window->get_window()), window(window) {
     m_pWindow = window->get_window();
 }
 
@@ -163,99 +162,24 @@ bool SelectionBorders::doesntWantBorders() {
 }
 
 
-// JumpDecoration
-JumpDecoration::JumpDecoration(PHLWINDOW window, const std::string &label) : IHyprWindowDecoration(window) {
-    m_pWindow = window;
-    m_sLabel = label;
-    m_iFrames = 0;
-    m_pTexture = nullptr;
-}
-
-JumpDecoration::~JumpDecoration() {
+// JumpPassElement
+JumpPassElement::JumpPassElement(JumpLabels *glyphs, std::vector<Label> &&labels) : glyphs(glyphs), labels(std::move(labels)) {
 }
 
-SDecorationPositioningInfo JumpDecoration::getPositioningInfo() {
-    SDecorationPositioningInfo info;
-    info.policy = DECORATION_POSITION_STICKY;
-    info.edges = DECORATION_EDGE_BOTTOM | DECORATION_EDGE_LEFT | DECORATION_EDGE_RIGHT | DECORATION_EDGE_TOP;
-    return info;
-}
-
-void JumpDecoration::onPositioningReply(const SDecorationPositioningReply& reply) {
-    m_bAssignedGeometry = reply.assignedGeometry;
-}
-
-CBox JumpDecoration::assignedBoxGlobal() {
-    static auto *const *TEXTSCALE = (Hyprlang::FLOAT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:jump_labels_scale")->getDataStaticPtr();
-    CBox box = m_bAssignedGeometry;
-    box.translate(g_pDecorationPositioner->getEdgeDefinedPoint(DECORATION_EDGE_BOTTOM | DECORATION_EDGE_LEFT | DECORATION_EDGE_RIGHT | DECORATION_EDGE_TOP, m_pWindow.lock()));
-    if (box.w > box.h) {
-        box.x += 0.5 * (box.w - box.h);
-        box.w = box.h;
-    } else {
-        box.y += 0.5 * (box.h - box.w);
-        box.h = box.w;
-    }
-
-    const double scale = **TEXTSCALE < 0.1 ? 0.1 : **TEXTSCALE > 1.0 ? 1.0 : **TEXTSCALE;
-    box.scaleFromCenter(scale);
-
-    const auto PWORKSPACE = m_pWindow->m_pWorkspace;
-
-    if (!PWORKSPACE)
-        return box;
-
-    const auto WORKSPACEOFFSET = PWORKSPACE->m_vRenderOffset->value();
-    return box.translate(WORKSPACEOFFSET);
-}
-
-void JumpDecoration::draw(PHLMONITOR pMonitor, float const& a) {
-    CBox windowBox = assignedBoxGlobal().translate(-pMonitor->vecPosition).scale(pMonitor->scale).round();
-
-    if (windowBox.width < 1 || windowBox.height < 1)
-        return;
-    
-    const bool ANIMATED = m_pWindow->m_vRealPosition->isBeingAnimated() || m_pWindow->m_vRealSize->isBeingAnimated();
-
-    if (m_pTexture.get() == nullptr) {
-        static auto  FALLBACKFONT = CConfigValue<std::string>("misc:font_family");
-        static auto const *TEXTFONTFAMILY = (Hyprlang::STRING const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:jump_labels_font")->getDataStaticPtr();
-        static auto *const *TEXTCOL = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:jump_labels_color")->getDataStaticPtr();
-        const CHyprColor color = CHyprColor(**TEXTCOL);
-        std::string font_family(*TEXTFONTFAMILY);
-        if (font_family == "")
-            font_family = *FALLBACKFONT;
-
-        auto TEXTFONTSIZE = windowBox.width / m_sLabel.size();
-        m_pTexture = g_pHyprOpenGL->renderText(m_sLabel, color, TEXTFONTSIZE, false, font_family, windowBox.width);
+void JumpPassElement::draw(const CRegion& damage) {
+    const double aspect = glyphs->get_aspect();
+    for (const auto &label : labels) {
+        // One quad per key, from the cached glyphs, in a row centred in the box
+        const double w = std::min(label.box.width / label.text.size(), label.box.height * aspect);
+        const double h = w / aspect;
+        CBox glyphBox = { label.box.x + 0.5 * (label.box.width - w * label.text.size()), label.box.y + 0.5 * (label.box.height - h), w, h };
+        for (char key : label.text) {
+            auto glyph = glyphs->get_glyph(key);
+            if (glyph != nullptr) {
+                CBox box = glyphBox;
+                g_pHyprOpenGL->renderTexture(glyph, box.round(), 1.0);
+            }
+            glyphBox.x += w;
+        }
     }
-
-    CTexPassElement::SRenderData data;
-    data.tex = m_pTexture;
-    data.box = windowBox;
-    g_pHyprRenderer->m_sRenderPass.add(makeShared<CTexPassElement>(data));
 }
-
-eDecorationType JumpDecoration::getDecorationType() {
-    return DECORATION_CUSTOM;
-}
-
-void JumpDecoration::updateWindow(PHLWINDOW) {
-}
-
-void JumpDecoration::damageEntire() {
-}
-
-eDecorationLayer JumpDecoration::getDecorationLayer() {
-    return DECORATION_LAYER_OVER;
-}
-
-uint64_t JumpDecoration::getDecorationFlags() {
-    return DECORATION_PART_OF_MAIN_WINDOW;
-}
-
-std::string JumpDecoration::getDisplayName() {
-    return "Overview";
-}
-
-
@@ -3,12 +3,14 @@
 
 #include <hyprland/src/render/decorations/IHyprWindowDecoration.hpp>
 #include <hyprland/src/render/Texture.hpp>
+#include <hyprland/src/render/pass/PassElement.hpp>
 
-class Window;
+class HyprlandWindow;
+class JumpLabels;
 
 class SelectionBorders : public IHyprWindowDecoration {
   public:
-    SelectionBorders(Window *);
+    SelectionBorders(HyprlandWindow *);
     virtual ~SelectionBorders();
 
     virtual SDecorationPositioningInfo getPositioningInfo();
@@ -22,7 +24,7 @@ class SelectionBorders : public IHyprWindowDecoration {
     virtual std::string                getDisplayName();
 
   private:
-    const Window *window;
+    const HyprlandWindow *window;
 
     SBoxExtents  m_seExtents;
     SBoxExtents  m_seReportedExtents;
@@ -35,29 +37,26 @@ class SelectionBorders : public IHyprWindowDecoration {
     bool         doesntWantBorders();
 };
 
-class JumpDecoration : public IHyprWindowDecoration {
+// Draws the jump labels of the monitor being rendered, in one pass element
+class JumpPassElement : public IPassElement {
   public:
-    JumpDecoration(PHLWINDOW, const std::string &label);
-    virtual ~JumpDecoration();
+    struct Label {
+        // In monitor pixels
+        CBox        box;
+        std::string text;
+    };
 
-    virtual SDecorationPositioningInfo getPositioningInfo();
-    virtual void                       onPositioningReply(const SDecorationPositioningReply& reply);
-    virtual void                       draw(PHLMONITOR, float const& a);
-    virtual eDecorationType            getDecorationType();
-    virtual void                       updateWindow(PHLWINDOW);
-    virtual void                       damageEntire();
-    virtual eDecorationLayer           getDecorationLayer();
-    virtual uint64_t                   getDecorationFlags();
-    virtual std::string                getDisplayName();
+    JumpPassElement(JumpLabels *glyphs, std::vector<Label> &&labels);
+    virtual ~JumpPassElement() = default;
 
-  private:
-    PHLWINDOWREF m_pWindow;
-    CBox m_bAssignedGeometry = { 0 };
-    CBox assignedBoxGlobal();
+    virtual void        draw(const CRegion& damage);
+    virtual bool        needsLiveBlur() { return false; }
+    virtual bool        needsPrecomputeBlur() { return false; }
+    virtual const char* passName() { return "JumpPassElement"; }
 
-    std::string m_sLabel;
-    int m_iFrames;
-    SP<CTexture> m_pTexture;
+  private:
+    JumpLabels        *glyphs;
+    std::vector<Label> labels;
 };
 
 #endif  // SCROLLER_DECORATIONS_H
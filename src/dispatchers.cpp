@@ -4,11 +4,16 @@
 #include <hyprland/src/managers/LayoutManager.hpp>
 #include <hyprland/src/plugins/PluginAPI.hpp>
 #include <hyprland/src/helpers/Monitor.hpp>
+#include <algorithm>
+#include <cctype>
 #include <optional>
+#include <string_view>
 
 #include "enums.h"
 #include "dispatchers.h"
 #include "scroller.h"
+#include "stats.h"
+#include "trace.h"
 
 
 extern HANDLE PHANDLE;
@@ -17,7 +22,36 @@ extern std::function<SDispatchResult(std::string)> orig_moveActiveTo;
 
 
 namespace dispatchers {
-    std::optional<Direction> parse_move_arg(std::string arg) {
+    // CVarList copies every argument into a vector of strings. The focus and
+    // move dispatchers run on every key press, so they look at their
+    // arguments in place instead.
+    // Returns the n-th comma separated argument, trimmed, or an empty one.
+    std::string_view get_arg(std::string_view args, size_t n) {
+        size_t start = 0;
+        for (size_t i = 0; i < n; ++i) {
+            start = args.find(',', start);
+            if (start == std::string_view::npos)
+                return {};
+            ++start;
+        }
+        auto arg = args.substr(start, args.find(',', start) - start);
+        while (!arg.empty() && std::isspace(static_cast<unsigned char>(arg.front())))
+            arg.remove_prefix(1);
+        while (!arg.empty() && std::isspace(static_cast<unsigned char>(arg.back())))
+            arg.remove_suffix(1);
+        return arg;
+    }
+
+    bool has_arg(std::string_view args, std::string_view value) {
+        const size_t nargs = std::count(args.begin(), args.end(), ',') + 1;
+        for (size_t n = 0; n < nargs; ++n) {
+            if (get_arg(args, n) == value)
+                return true;
+        }
+        return false;
+    }
+
+    std::optional<Direction> parse_move_arg(std::string_view arg) {
         if (arg == "l" || arg == "left")
             return Direction::Left;
         else if (arg == "r" || arg == "right")
@@ -138,8 +172,7 @@ namespace dispatchers {
         if (workspace == -1)
             return { .success = false, .error = "scroller:movefocus: invalid workspace" };
 
-        auto args = CVarList(arg);
-        if (auto direction = parse_move_arg(args[0])) {
+        if (auto direction = parse_move_arg(get_arg(arg, 0))) {
             if (direction != Direction::Invalid)
                 g_ScrollerLayout->move_focus(workspace, *direction);
         }
@@ -152,10 +185,9 @@ namespace dispatchers {
         if (workspace == -1)
             return { .success = false, .error = "scroller:movewindow: invalid workspace" };
 
-        auto args = CVarList(arg);
-        if (auto direction = parse_move_arg(args[0])) {
+        if (auto direction = parse_move_arg(get_arg(arg, 0))) {
             if (direction != Direction::Invalid) {
-                bool nomode = args.contains("nomode");
+                bool nomode = has_arg(arg, "nomode");
                 g_ScrollerLayout->move_window(workspace, *direction, nomode);
             } else {
                orig_moveActiveTo(arg);
@@ -170,8 +202,7 @@ namespace dispatchers {
         if (workspace == -1)
             return { .success = false, .error = "scroller:alignwindow: invalid workspace" };
 
-        auto args = CVarList(arg);
-        if (auto direction = parse_move_arg(args[0])) {
+        if (auto direction = parse_move_arg(get_arg(arg, 0))) {
             if (direction != Direction::Invalid)
                 g_ScrollerLayout->align_window(workspace, *direction);
         }
@@ -457,42 +488,85 @@ namespace dispatchers {
 
         return {};
     }
+    SDispatchResult dispatch_tracedump(std::string arg) {
+        std::string path = arg;
+        if (path.empty()) {
+            const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+            path = std::string(runtime_dir != nullptr ? runtime_dir : "/tmp") + "/hyprscroller-trace.json";
+        }
+        if (!flight_recorder.dump(path))
+            return { .success = false, .error = "scroller:tracedump: cannot write " + path };
+        return {};
+    }
+    SDispatchResult dispatch_record(std::string arg) {
+        if (arg == "stop") {
+            g_ScrollerLayout->record_stop();
+            return {};
+        }
+        std::string path = arg;
+        if (path.empty() || path == "start") {
+            const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+            path = std::string(runtime_dir != nullptr ? runtime_dir : "/tmp") + "/hyprscroller-record.log";
+        }
+        if (!g_ScrollerLayout->record_start(path))
+            return { .success = false, .error = "scroller:record: cannot write " + path };
+        return {};
+    }
+
+    // Registers a dispatcher, recording its entry and exit in the flight recorder,
+    // counting the layout work it does, and scheduling a layout snapshot.
+    // Dispatchers that change the arrangement (arranges is true) end
+    // restoring the previous snapshot when they succeed; focus changes and
+    // the rest don't.
+    static void add_dispatcher(const char *name, SDispatchResult (*dispatch)(std::string), bool arranges) {
+        HyprlandAPI::addDispatcherV2(PHANDLE, std::string("scroller:") + name, [name, dispatch, arranges](std::string arg) {
+            auto window = g_pCompositor->m_pLastWindow.lock();
+            TraceScope scope(TraceCategory::Dispatcher, name, workspace_for_action(), (uint64_t)window.get());
+            StatsScope stats(StatsTrigger::Dispatcher);
+            auto result = dispatch(arg);
+            g_ScrollerLayout->snapshot_changed(arranges && result.success);
+            return result;
+        });
+    }
+
     void addDispatchers() {
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:cyclesize", dispatch_cyclesize);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:cyclewidth", dispatch_cyclewidth);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:cycleheight", dispatch_cycleheight);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:setsize", dispatch_setsize);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:setwidth", dispatch_setwidth);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:setheight", dispatch_setheight);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:movefocus", dispatch_movefocus);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:movewindow", dispatch_movewindow);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:alignwindow", dispatch_alignwindow);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:admitwindow", dispatch_admitwindow);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:expelwindow", dispatch_expelwindow);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:setmode", dispatch_setmode);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:setmodemodifier", dispatch_setmodemodifier);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:fitsize", dispatch_fitsize);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:fitwidth", dispatch_fitwidth);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:fitheight", dispatch_fitheight);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:toggleoverview", dispatch_toggleoverview);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:marksadd", dispatch_marksadd);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:marksdelete", dispatch_marksdelete);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:marksvisit", dispatch_marksvisit);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:marksreset", dispatch_marksreset);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:pin", dispatch_pin);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:selectiontoggle", dispatch_selectiontoggle);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:selectionreset", dispatch_selectionreset);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:selectionworkspace", dispatch_selectionworkspace);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:selectionmove", dispatch_selectionmove);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:trailnew", dispatch_trailnew);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:trailnext", dispatch_trailnext);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:trailprevious", dispatch_trailprev);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:traildelete", dispatch_traildelete);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:trailclear", dispatch_trailclear);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:trailtoselection", dispatch_trailtoselection);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:trailmarktoggle", dispatch_trailmarktoggle);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:trailmarknext", dispatch_trailmarknext);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:trailmarkprevious", dispatch_trailmarkprev);
-        HyprlandAPI::addDispatcherV2(PHANDLE, "scroller:jump", dispatch_jump);
+        add_dispatcher("cyclesize", dispatch_cyclesize, true);
+        add_dispatcher("cyclewidth", dispatch_cyclewidth, true);
+        add_dispatcher("cycleheight", dispatch_cycleheight, true);
+        add_dispatcher("setsize", dispatch_setsize, true);
+        add_dispatcher("setwidth", dispatch_setwidth, true);
+        add_dispatcher("setheight", dispatch_setheight, true);
+        add_dispatcher("movefocus", dispatch_movefocus, false);
+        add_dispatcher("movewindow", dispatch_movewindow, true);
+        add_dispatcher("alignwindow", dispatch_alignwindow, false);
+        add_dispatcher("admitwindow", dispatch_admitwindow, true);
+        add_dispatcher("expelwindow", dispatch_expelwindow, true);
+        add_dispatcher("setmode", dispatch_setmode, true);
+        add_dispatcher("setmodemodifier", dispatch_setmodemodifier, false);
+        add_dispatcher("fitsize", dispatch_fitsize, true);
+        add_dispatcher("fitwidth", dispatch_fitwidth, true);
+        add_dispatcher("fitheight", dispatch_fitheight, true);
+        add_dispatcher("toggleoverview", dispatch_toggleoverview, false);
+        add_dispatcher("marksadd", dispatch_marksadd, true);
+        add_dispatcher("marksdelete", dispatch_marksdelete, true);
+        add_dispatcher("marksvisit", dispatch_marksvisit, false);
+        add_dispatcher("marksreset", dispatch_marksreset, true);
+        add_dispatcher("pin", dispatch_pin, true);
+        add_dispatcher("selectiontoggle", dispatch_selectiontoggle, false);
+        add_dispatcher("selectionreset", dispatch_selectionreset, false);
+        add_dispatcher("selectionworkspace", dispatch_selectionworkspace, true);
+        add_dispatcher("selectionmove", dispatch_selectionmove, true);
+        add_dispatcher("trailnew", dispatch_trailnew, true);
+        add_dispatcher("trailnext", dispatch_trailnext, false);
+        add_dispatcher("trailprevious", dispatch_trailprev, false);
+        add_dispatcher("traildelete", dispatch_traildelete, true);
+        add_dispatcher("trailclear", dispatch_trailclear, true);
+        add_dispatcher("trailtoselection", dispatch_trailtoselection, false);
+        add_dispatcher("trailmarktoggle", dispatch_trailmarktoggle, true);
+        add_dispatcher("trailmarknext", dispatch_trailmarknext, false);
+        add_dispatcher("trailmarkprevious", dispatch_trailmarkprev, false);
+        add_dispatcher("jump", dispatch_jump, false);
+        add_dispatcher("tracedump", dispatch_tracedump, false);
+        add_dispatcher("record", dispatch_record, false);
     }
 }
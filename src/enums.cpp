@@ -1,10 +1,8 @@
 #include <hyprutils/string/VarList.hpp>
-#include <hyprland/src/config/ConfigManager.hpp>
-#include <hyprland/src/plugins/PluginAPI.hpp>
 
 #include "enums.h"
 
-extern HANDLE PHANDLE;
+using Hyprutils::String::CVarList;
 
 ModeModifier::ModeModifier() : position(POSITION_UNDEFINED), focus(FOCUS_UNDEFINED), auto_mode(AUTO_UNDEFINED), auto_param(2) {}
 
@@ -53,7 +51,7 @@ int ModeModifier::get_position(bool force_default) const {
     return position;
 }
 
-std::string ModeModifier::get_position_string() const {
+const char *ModeModifier::get_position_string() const {
     auto pos = get_position();
     switch (pos) {
     case POSITION_AFTER:
@@ -78,7 +76,7 @@ int ModeModifier::get_focus(bool force_default) const {
     return focus;
 }
 
-std::string ModeModifier::get_focus_string() const {
+const char *ModeModifier::get_focus_string() const {
     if (get_focus() == FOCUS_FOCUS)
         return "focus";
     return "nofocus";
@@ -98,7 +96,7 @@ int ModeModifier::get_auto_mode(bool force_default) const {
     return auto_mode;
 }
 
-std::string ModeModifier::get_auto_mode_string() const {
+const char *ModeModifier::get_auto_mode_string() const {
     if (get_auto_mode() == AUTO_MANUAL)
         return "manual";
     return "auto";
@@ -112,16 +110,12 @@ void ModeModifier::set_center_column(bool c) {
     center_column = c;
 }
 
-std::optional<bool> ModeModifier::get_center_column(bool force_default) const {
-    if (force_default && !center_column.has_value()) {
-        static auto* const *center_active_column = (Hyprlang::INT* const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:center_active_column")->getDataStaticPtr();
-        return **center_active_column;
-    }
+std::optional<bool> ModeModifier::get_center_column() const {
     return center_column;
 }
 
-std::string ModeModifier::get_center_column_string() const {
-    if (get_center_column() == false)
+const char *ModeModifier::get_center_column_string(bool default_center) const {
+    if (get_center_column().value_or(default_center) == false)
         return "nocenter_column";
     return "center_column";
 }
@@ -130,16 +124,12 @@ void ModeModifier::set_center_window(bool c) {
     center_window = c;
 }
 
-std::optional<bool> ModeModifier::get_center_window(bool force_default) const {
-    if (force_default && !center_window.has_value()) {
-        static auto* const *center_active_window = (Hyprlang::INT* const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:center_active_window")->getDataStaticPtr();
-        return **center_active_window;
-    }
+std::optional<bool> ModeModifier::get_center_window() const {
     return center_window;
 }
 
-std::string ModeModifier::get_center_window_string() const {
-    if (get_center_window() == false)
+const char *ModeModifier::get_center_window_string(bool default_center) const {
+    if (get_center_window().value_or(default_center) == false)
         return "nocenter_window";
     return "center_window";
 }
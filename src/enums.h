@@ -9,6 +9,27 @@ enum class AdmitExpelDirection { Left, Right };
 enum class FitSize { Active, Visible, All, ToEnd, ToBeg };
 enum class Mode { Row, Column };
 
+enum class StandardSize {
+    OneEighth = 0,
+    OneSixth,
+    OneFourth,
+    OneThird,
+    ThreeEighths,
+    OneHalf,
+    FiveEighths,
+    TwoThirds,
+    ThreeQuarters,
+    FiveSixths,
+    SevenEighths,
+    One,
+    Free
+};
+
+enum class Reorder {
+    Auto,
+    Lazy
+};
+
 class ModeModifier {
 public:
     enum {
@@ -34,22 +55,23 @@ public:
     ModeModifier(const std::string &arg);
     void set_position(int p);
     int get_position(bool force_default = true) const;
-    std::string get_position_string() const;
+    const char *get_position_string() const;
     void set_focus(int f);
     int get_focus(bool force_default = true) const;
-    std::string get_focus_string() const;
+    const char *get_focus_string() const;
     void set_auto_mode(int mode);
     void set_auto_param(int param);
     int get_auto_mode(bool force_default = true) const;
-    std::string get_auto_mode_string() const;
+    const char *get_auto_mode_string() const;
     int get_auto_param() const;
 
+    // Undefined center options take their value from the configuration
     void set_center_column(bool c);
-    std::optional<bool> get_center_column(bool force_default = true) const;
-    std::string get_center_column_string() const;
+    std::optional<bool> get_center_column() const;
+    const char *get_center_column_string(bool default_center) const;
     void set_center_window(bool c);
-    std::optional<bool> get_center_window(bool force_default = true) const;
-    std::string get_center_window_string() const;
+    std::optional<bool> get_center_window() const;
+    const char *get_center_window_string(bool default_center) const;
 
 private:
     int position;
@@ -0,0 +1,15 @@
+#include "events.h"
+
+void EventBus::post(EventTopic topic, std::string_view data)
+{
+    Topic &t = topics[static_cast<size_t>(topic)];
+    if (!t.pending) {
+        // Nothing to do if the state is the one listeners already have
+        if (is_state(topic) && t.emitted && data == t.last)
+            return;
+        t.pending = true;
+        order[npending++] = topic;
+    }
+    // Assignment reuses the string's buffer
+    t.next.assign(data);
+}
@@ -0,0 +1,69 @@
+#ifndef SCROLLER_EVENTS_H
+#define SCROLLER_EVENTS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Topics of the "scroller" IPC events, see the IPC section of the README
+enum class EventTopic : uint8_t {
+    Mode,
+    Overview,
+    AdmitWindow,
+    ExpelWindow,
+    Mark,
+    Trail,
+    TrailMark,
+    Count
+};
+
+// Coalesces the events posted by the layout until the adapter flushes them,
+// once per event loop iteration. Each pending topic is then emitted once,
+// with the last data posted for it. Topics that describe state (everything
+// except admitwindow and expelwindow) remember the data they last emitted,
+// and are not emitted again until it changes, so switching workspaces or
+// focus doesn't flood listeners with repeated state. After every topic has
+// been posted once, posting doesn't allocate.
+class EventBus {
+public:
+    EventBus() : npending(0) {}
+
+    void post(EventTopic topic, std::string_view data);
+    bool has_pending() const { return npending > 0; }
+    // Calls emit(std::string_view data) for every pending topic that has
+    // something new, in the order they were first posted.
+    template <typename Emit>
+    void flush(Emit emit) {
+        for (size_t i = 0; i < npending; ++i) {
+            Topic &topic = topics[static_cast<size_t>(order[i])];
+            topic.pending = false;
+            if (is_state(order[i])) {
+                if (topic.emitted && topic.next == topic.last)
+                    continue;
+                topic.last = topic.next;
+                topic.emitted = true;
+            }
+            emit(std::string_view(topic.next));
+        }
+        npending = 0;
+    }
+
+private:
+    static bool is_state(EventTopic topic) {
+        return topic != EventTopic::AdmitWindow && topic != EventTopic::ExpelWindow;
+    }
+
+    struct Topic {
+        std::string next;
+        std::string last;
+        bool pending = false;
+        bool emitted = false;
+    };
+
+    static constexpr size_t COUNT = static_cast<size_t>(EventTopic::Count);
+    Topic topics[COUNT];
+    EventTopic order[COUNT];
+    size_t npending;
+};
+
+#endif // SCROLLER_EVENTS_H
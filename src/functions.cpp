@@ -1,20 +1,31 @@
 #include "functions.h"
 #include "dispatchers.h"
+#include "scroller.h"
+#include "stats.h"
+#include "trace.h"
 
 #include <hyprland/src/Compositor.hpp>
 #include <hyprland/src/helpers/Monitor.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
 
+extern std::unique_ptr<ScrollerLayout> g_ScrollerLayout;
+
 SDispatchResult this_moveFocusTo(std::string args)
 {
-    dispatchers::dispatch_movefocus(args);
+    TraceScope scope(TraceCategory::Dispatcher, "movefocus", get_workspace_id());
+    StatsScope stats(StatsTrigger::Dispatcher);
+    dispatchers::dispatch_movefocus(std::move(args));
+    g_ScrollerLayout->snapshot_changed(false);
     return {};
 }
 
 
 SDispatchResult this_moveActiveTo(std::string args)
 {
-    dispatchers::dispatch_movewindow(args);
+    TraceScope scope(TraceCategory::Dispatcher, "movewindow", get_workspace_id());
+    StatsScope stats(StatsTrigger::Dispatcher);
+    dispatchers::dispatch_movewindow(std::move(args));
+    g_ScrollerLayout->snapshot_changed(true);
     return {};
 }
 
@@ -0,0 +1,458 @@
+#include <hyprland/src/Compositor.hpp>
+#include <hyprland/src/config/ConfigManager.hpp>
+#include <hyprland/src/config/ConfigValue.hpp>
+#include <hyprland/src/desktop/Workspace.hpp>
+#include <hyprland/src/helpers/Monitor.hpp>
+#include <hyprland/src/managers/EventManager.hpp>
+#include <hyprland/src/managers/KeybindManager.hpp>
+#include <hyprland/src/managers/input/InputManager.hpp>
+#include <hyprland/src/plugins/PluginAPI.hpp>
+#include <hyprland/src/render/Renderer.hpp>
+
+#include "hyprland.h"
+#include "decorations.h"
+#include "functions.h"
+#include "overview.h"
+#include "record.h"
+#include "trace.h"
+
+extern HANDLE PHANDLE;
+extern Overview *overviews;
+extern std::function<SDispatchResult(std::string)> orig_moveFocusTo;
+
+static const std::string no_monitor;
+// Compiled by HyprlandAdapter::compile_config()
+static CHyprColor selection_border_color;
+
+static eFullscreenMode to_hyprland(FullscreenMode mode)
+{
+    switch (mode) {
+    case FullscreenMode::Maximized:
+        return eFullscreenMode::FSMODE_MAXIMIZED;
+    case FullscreenMode::Fullscreen:
+        return eFullscreenMode::FSMODE_FULLSCREEN;
+    case FullscreenMode::None:
+    default:
+        return eFullscreenMode::FSMODE_NONE;
+    }
+}
+
+static char direction_to_char(Direction direction)
+{
+    switch (direction) {
+    case Direction::Left:
+        return 'l';
+    case Direction::Right:
+        return 'r';
+    case Direction::Up:
+        return 'u';
+    case Direction::Down:
+    default:
+        return 'd';
+    }
+}
+
+// HyprlandWindow
+HyprlandWindow::HyprlandWindow(PHLWINDOW window) : window(window), id(window_id(window)), selected(false), decoration(nullptr)
+{
+}
+
+HyprlandWindow::~HyprlandWindow()
+{
+    set_selected(false);
+}
+
+// Unselected windows keep Hyprland's border, so only selected ones carry a
+// decoration drawing over it
+void HyprlandWindow::set_selected(bool selected)
+{
+    this->selected = selected;
+    // Windows destroyed while the layout was disabled took their decorations
+    // with them
+    const auto w = window.lock();
+    if (w == nullptr) {
+        decoration = nullptr;
+        return;
+    }
+    if (selected && decoration == nullptr) {
+        auto deco = makeUnique<SelectionBorders>(this);
+        decoration = deco.get();
+        HyprlandAPI::addWindowDecoration(PHANDLE, w, std::move(deco));
+        damage();
+    } else if (!selected && decoration != nullptr) {
+        damage();
+        w->removeWindowDeco(decoration);
+        decoration = nullptr;
+    }
+}
+
+void HyprlandWindow::damage()
+{
+    const auto w = window.lock();
+    if (w == nullptr)
+        return;
+    // Overview scales the content of its monitor, so window boxes don't
+    // map to its pixels
+    if (overviews != nullptr && overviews->overview_enabled(w->workspaceID())) {
+        const auto monitor = w->m_pMonitor.lock();
+        if (monitor != nullptr)
+            g_pHyprRenderer->damageMonitor(monitor);
+        return;
+    }
+    g_pHyprRenderer->damageWindow(w);
+}
+
+CGradientValueData HyprlandWindow::get_border_color() const
+{
+    return selected ? selection_border_color : window->m_cRealBorderColor;
+}
+
+const std::string &HyprlandWindow::get_monitor_name() const
+{
+    const auto monitor = window->m_pMonitor.lock();
+    return monitor != nullptr ? monitor->szName : no_monitor;
+}
+
+std::vector<std::string> HyprlandWindow::get_rules(const std::string &name) const
+{
+    std::vector<std::string> rules;
+    const std::string rule_name = "plugin:scroller:" + name;
+    for (auto &r: window->m_vMatchedRules) {
+        if (r->szRule.starts_with(rule_name))
+            rules.push_back(r->szRule.substr(r->szRule.find_first_of(' ') + 1));
+    }
+    return rules;
+}
+
+std::vector<std::pair<std::string, std::string>> HyprlandWindow::get_all_rules() const
+{
+    std::vector<std::pair<std::string, std::string>> rules;
+    const std::string prefix = "plugin:scroller:";
+    for (auto &r: window->m_vMatchedRules) {
+        if (r->szRule.starts_with(prefix)) {
+            const auto space = r->szRule.find_first_of(' ');
+            rules.push_back({ r->szRule.substr(prefix.size(), space - prefix.size()),
+                              space != std::string::npos ? r->szRule.substr(space + 1) : "" });
+        }
+    }
+    return rules;
+}
+
+Extents HyprlandWindow::get_reserved_area() const
+{
+    SBoxExtents reserved_area = window->getFullWindowReservedArea();
+    return Extents { reserved_area.topLeft, reserved_area.bottomRight };
+}
+
+bool HyprlandWindow::commit(bool animate)
+{
+    // A relayout leaves most windows where they were. Without animation,
+    // one still moving has to be warped to its goal.
+    if (window->m_vRealPosition->goal() == window->m_vPosition && window->m_vRealSize->goal() == window->m_vSize &&
+        (animate || (!window->m_vRealPosition->isBeingAnimated() && !window->m_vRealSize->isBeingAnimated())))
+        return false;
+    if (!animate)
+        window->m_vRealPosition->warp(false);
+    *window->m_vRealPosition = window->m_vPosition;
+    *window->m_vRealSize = window->m_vSize;
+    flight_recorder.instant(TraceCategory::Window, "sendWindowSize", window->workspaceID(), id);
+    window->sendWindowSize();
+    return true;
+}
+
+void HyprlandWindow::commit_position(bool animate)
+{
+    if (!animate)
+        window->m_vRealPosition->warp(false);
+    *window->m_vRealPosition = window->m_vPosition;
+}
+
+FullscreenMode HyprlandWindow::get_fullscreen_mode() const
+{
+    return to_fullscreen_mode(window_fullscreen_state(window.lock()));
+}
+
+void HyprlandWindow::toggle_fullscreen(FullscreenMode mode)
+{
+    toggle_window_fullscreen_internal(window.lock(), to_hyprland(mode));
+}
+
+void HyprlandWindow::pin(bool pin)
+{
+    if (pin) {
+        window->m_tags.applyTag("+scroller:pinned");
+    } else {
+        window->m_tags.applyTag("-scroller:pinned");
+    }
+    window->updateDynamicRules();
+    g_pCompositor->updateWindowAnimatedDecorationValues(window.lock());
+}
+
+void HyprlandWindow::move_to_workspace(WorkspaceID workspace)
+{
+    PHLWORKSPACE pworkspace = g_pCompositor->getWorkspaceByID(workspace);
+    if (pworkspace == nullptr)
+        return;
+    window->moveToWorkspace(pworkspace);
+    window->m_pMonitor = pworkspace->m_pMonitor;
+}
+
+void HyprlandWindow::focus()
+{
+    g_pCompositor->focusWindow(window.lock());
+}
+
+void HyprlandWindow::force_focus()
+{
+    force_focus_to_window(window.lock());
+}
+
+void HyprlandWindow::update_relative_cursor_coords()
+{
+    ::update_relative_cursor_coords(window.lock());
+}
+
+// HyprlandAdapter
+// Hyprland keeps the address of option values through reloads
+static Hyprlang::INT *const *config_int(const char *name)
+{
+    return (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, name)->getDataStaticPtr();
+}
+
+static Hyprlang::STRING const *config_string(const char *name)
+{
+    return (Hyprlang::STRING const *)HyprlandAPI::getConfigValue(PHANDLE, name)->getDataStaticPtr();
+}
+
+struct SizeOptions {
+    Hyprlang::STRING const *window_default_height;
+    Hyprlang::STRING const *column_default_width;
+    Hyprlang::STRING const *window_heights;
+    Hyprlang::STRING const *column_widths;
+    Hyprlang::STRING const *monitor_options;
+    Hyprlang::INT *const *cyclesize_wrap;
+};
+
+static const SizeOptions &size_options()
+{
+    static const SizeOptions options = {
+        config_string("plugin:scroller:window_default_height"),
+        config_string("plugin:scroller:column_default_width"),
+        config_string("plugin:scroller:window_heights"),
+        config_string("plugin:scroller:column_widths"),
+        config_string("plugin:scroller:monitor_options"),
+        config_int("plugin:scroller:cyclesize_wrap"),
+    };
+    return options;
+}
+
+bool HyprlandAdapter::compile_config()
+{
+    static auto *const *CENTER_ROW = config_int("plugin:scroller:center_row_if_space_available");
+    static auto *const *CENTER_COLUMN = config_int("plugin:scroller:center_active_column");
+    static auto *const *CENTER_WINDOW = config_int("plugin:scroller:center_active_window");
+    static auto *const *CYCLESIZE_CLOSEST = config_int("plugin:scroller:cyclesize_closest");
+    static auto *const *OVERVIEW_SCALE_CONTENT = config_int("plugin:scroller:overview_scale_content");
+    static auto *const *SELECTEDCOL = config_int("plugin:scroller:col.selection_border");
+
+    const LayoutConfig previous = config;
+    config.center_row_if_space_available = **CENTER_ROW;
+    config.center_active_column = **CENTER_COLUMN;
+    config.center_active_window = **CENTER_WINDOW;
+    config.cyclesize_closest = **CYCLESIZE_CLOSEST;
+    config.overview_scale_content = **OVERVIEW_SCALE_CONTENT;
+    bool changed = !compiled || config != previous;
+
+    const SizeOptions &options = size_options();
+    if (sizes.update(*options.window_default_height, *options.column_default_width, *options.window_heights,
+                     *options.column_widths, *options.monitor_options, **options.cyclesize_wrap))
+        changed = true;
+
+    const CHyprColor color = **SELECTEDCOL;
+    if (color != selection_border_color) {
+        selection_border_color = color;
+        changed = true;
+    }
+    compiled = true;
+    return changed;
+}
+
+const LayoutConfig &HyprlandAdapter::get_config()
+{
+    if (!compiled)
+        compile_config();
+    if (recorder.is_recording())
+        recorder.config(config);
+    return config;
+}
+
+ScrollerSizes &HyprlandAdapter::get_sizes()
+{
+    if (!compiled)
+        compile_config();
+    if (recorder.is_recording()) {
+        const SizeOptions &options = size_options();
+        recorder.sizes(*options.window_default_height, *options.column_default_width, *options.window_heights,
+                       *options.column_widths, *options.monitor_options, **options.cyclesize_wrap);
+    }
+    return sizes;
+}
+
+MonitorID HyprlandAdapter::get_active_monitor() const
+{
+    const auto monitor = g_pCompositor->m_pLastMonitor.lock();
+    if (monitor == nullptr)
+        return MONITOR_INVALID;
+    if (recorder.is_recording()) {
+        recorder.monitor(monitor->ID, monitor->szName, Box(monitor->vecPosition, monitor->vecSize));
+        recorder.active_monitor(monitor->ID);
+    }
+    return monitor->ID;
+}
+
+const std::string &HyprlandAdapter::get_monitor_name(MonitorID monitor_id) const
+{
+    const auto monitor = g_pCompositor->getMonitorFromID(monitor_id);
+    if (monitor == nullptr)
+        return no_monitor;
+    if (recorder.is_recording())
+        recorder.monitor(monitor->ID, monitor->szName, Box(monitor->vecPosition, monitor->vecSize));
+    return monitor->szName;
+}
+
+Viewport HyprlandAdapter::get_viewport(MonitorID monitor_id, WorkspaceID workspace) const
+{
+    const auto monitor = g_pCompositor->getMonitorFromID(monitor_id);
+    if (monitor == nullptr)
+        return Viewport {};
+    // for gaps outer
+    static auto PGAPSINDATA = CConfigValue<Hyprlang::CUSTOMTYPE>("general:gaps_in");
+    static auto PGAPSOUTDATA = CConfigValue<Hyprlang::CUSTOMTYPE>("general:gaps_out");
+    auto *const PGAPSIN = (CCssGapData *)(PGAPSINDATA.ptr())->getData();
+    auto *const PGAPSOUT = (CCssGapData *)(PGAPSOUTDATA.ptr())->getData();
+    const auto WORKSPACERULE = g_pConfigManager->getWorkspaceRuleFor(g_pCompositor->getWorkspaceByID(workspace));
+    // For now, support only constant CCssGapData
+    auto gaps_in = WORKSPACERULE.gapsIn.value_or(*PGAPSIN).top;
+    auto gaps_out = WORKSPACERULE.gapsOut.value_or(*PGAPSOUT);
+    const auto SIZE = monitor->vecSize;
+    const auto POS = monitor->vecPosition;
+    const auto TOPLEFT = monitor->vecReservedTopLeft;
+    const auto BOTTOMRIGHT = monitor->vecReservedBottomRight;
+
+    Viewport viewport;
+    viewport.full = Box(POS, SIZE);
+    viewport.max = Box(POS.x + TOPLEFT.x + gaps_out.left,
+                       POS.y + TOPLEFT.y + gaps_out.top,
+                       SIZE.x - TOPLEFT.x - BOTTOMRIGHT.x - gaps_out.left - gaps_out.right,
+                       SIZE.y - TOPLEFT.y - BOTTOMRIGHT.y - gaps_out.top - gaps_out.bottom);
+    viewport.gap = gaps_in;
+    if (recorder.is_recording()) {
+        recorder.monitor(monitor->ID, monitor->szName, viewport.full);
+        recorder.viewport(monitor->ID, workspace, viewport);
+    }
+    return viewport;
+}
+
+MonitorID HyprlandAdapter::get_workspace_monitor(WorkspaceID workspace) const
+{
+    const auto PWORKSPACE = g_pCompositor->getWorkspaceByID(workspace);
+    const auto monitor = PWORKSPACE != nullptr ? PWORKSPACE->m_pMonitor.lock() : nullptr;
+    if (monitor == nullptr)
+        return get_active_monitor();
+    if (recorder.is_recording()) {
+        recorder.monitor(monitor->ID, monitor->szName, Box(monitor->vecPosition, monitor->vecSize));
+        recorder.workspace(workspace, monitor->ID, is_workspace_visible(workspace));
+    }
+    return monitor->ID;
+}
+
+bool HyprlandAdapter::is_workspace_visible(WorkspaceID workspace) const
+{
+    const auto PWORKSPACE = g_pCompositor->getWorkspaceByID(workspace);
+    const auto monitor = PWORKSPACE != nullptr ? PWORKSPACE->m_pMonitor.lock() : nullptr;
+    // Workspaces without a monitor are laid out like before, right away
+    if (monitor == nullptr)
+        return true;
+    const bool visible = monitor->activeWorkspaceID() == workspace || monitor->activeSpecialWorkspaceID() == workspace;
+    if (recorder.is_recording())
+        recorder.workspace(workspace, monitor->ID, visible);
+    return visible;
+}
+
+bool HyprlandAdapter::has_monitor_in_direction(Direction direction) const
+{
+    const bool exists = g_pCompositor->getMonitorInDirection(direction_to_char(direction)) != nullptr;
+    if (recorder.is_recording())
+        recorder.monitor_in_direction(direction, exists);
+    return exists;
+}
+
+void HyprlandAdapter::focus_monitor_in_direction(Direction direction)
+{
+    orig_moveFocusTo(std::string(1, direction_to_char(direction)));
+}
+
+Vector2D HyprlandAdapter::get_mouse_coords() const
+{
+    const Vector2D coords = g_pInputManager->getMouseCoordsInternal();
+    if (recorder.is_recording())
+        recorder.mouse(coords);
+    return coords;
+}
+
+void HyprlandAdapter::damage_workspace(WorkspaceID workspace)
+{
+    const auto PWORKSPACE = g_pCompositor->getWorkspaceByID(workspace);
+    if (PWORKSPACE == nullptr)
+        return;
+    const auto monitor = PWORKSPACE->m_pMonitor.lock();
+    if (monitor != nullptr)
+        g_pHyprRenderer->damageMonitor(monitor);
+}
+
+bool HyprlandAdapter::overview_enable(WorkspaceID workspace)
+{
+    return overviews->enable(workspace);
+}
+
+void HyprlandAdapter::overview_set_scale(WorkspaceID workspace, double scale)
+{
+    overviews->set_scale(workspace, scale);
+    const auto PWORKSPACE = g_pCompositor->getWorkspaceByID(workspace);
+    if (PWORKSPACE != nullptr && PWORKSPACE->m_pMonitor)
+        overviews->set_vecsize(workspace, PWORKSPACE->m_pMonitor->vecSize);
+}
+
+void HyprlandAdapter::overview_disable(WorkspaceID workspace)
+{
+    if (overviews->is_initialized())
+        overviews->disable(workspace);
+}
+
+static int flush_events(void *data)
+{
+    static_cast<HyprlandAdapter *>(data)->flush_events();
+    return 0;
+}
+
+HyprlandAdapter::~HyprlandAdapter()
+{
+    if (events_flush != nullptr)
+        wl_event_source_remove(events_flush);
+}
+
+void HyprlandAdapter::post_event(EventTopic topic, std::string_view data)
+{
+    events.post(topic, data);
+    // Idle sources run once, when the event loop has nothing else to do
+    if (events_flush == nullptr && events.has_pending())
+        events_flush = wl_event_loop_add_idle(g_pCompositor->m_sWLEventLoop, ::flush_events, this);
+}
+
+void HyprlandAdapter::flush_events()
+{
+    events_flush = nullptr;
+    events.flush([](std::string_view data) {
+        g_pEventManager->postEvent(SHyprIPCEvent{"scroller", std::string(data)});
+    });
+}
@@ -0,0 +1,122 @@
+#ifndef SCROLLER_HYPRLAND_H
+#define SCROLLER_HYPRLAND_H
+
+#include <hyprland/src/desktop/Window.hpp>
+#include <hyprland/src/config/ConfigDataValues.hpp>
+
+#include "adapter.h"
+#include "sizes.h"
+
+class SelectionBorders;
+
+// Hyprland implementation of the layout core adapters
+
+class HyprlandWindow : public WindowAdapter {
+public:
+    HyprlandWindow(PHLWINDOW window);
+    virtual ~HyprlandWindow();
+
+    PHLWINDOW get_window() const { return window.lock(); }
+    CGradientValueData get_border_color() const;
+    // Selected windows have a SelectionBorders decoration, the rest none
+    bool is_selected() const { return selected; }
+    // Every "plugin:scroller:<name>" rule matching the window, as (name, argument)
+    std::vector<std::pair<std::string, std::string>> get_all_rules() const;
+
+    virtual WindowID get_id() const { return id; }
+    virtual const std::string &get_monitor_name() const;
+    virtual std::vector<std::string> get_rules(const std::string &name) const;
+
+    virtual Extents get_reserved_area() const;
+    virtual const Vector2D &get_position() const { return window->m_vPosition; }
+    virtual void set_position(const Vector2D &position) { window->m_vPosition = position; }
+    virtual const Vector2D &get_size() const { return window->m_vSize; }
+    virtual void set_size(const Vector2D &size) { window->m_vSize = size; }
+    virtual bool commit(bool animate);
+    virtual void commit_position(bool animate);
+
+    virtual FullscreenMode get_fullscreen_mode() const;
+    virtual void toggle_fullscreen(FullscreenMode mode);
+
+    virtual void set_selected(bool selected);
+    virtual void damage();
+    virtual void pin(bool pin);
+    virtual void move_to_workspace(WorkspaceID workspace);
+    virtual void set_no_initial_focus() { window->m_bNoInitialFocus = true; }
+
+    virtual void focus();
+    virtual void force_focus();
+    virtual void warp_cursor() { window->warpCursor(); }
+    virtual void update_relative_cursor_coords();
+
+private:
+    PHLWINDOWREF window;
+    WindowID id;
+    bool selected;
+    SelectionBorders *decoration;
+};
+
+class HyprlandAdapter : public LayoutAdapter {
+public:
+    HyprlandAdapter() : compiled(false), events_flush(nullptr) {}
+    virtual ~HyprlandAdapter();
+
+    // Parses the plugin options into the layout config, sizes and the
+    // selection border color. The layout calls it when it is enabled and
+    // when the config is reloaded, so it is the only place that reads
+    // them. Returns true if anything changed.
+    bool compile_config();
+
+    virtual const LayoutConfig &get_config();
+    virtual ScrollerSizes &get_sizes();
+
+    virtual MonitorID get_active_monitor() const;
+    virtual const std::string &get_monitor_name(MonitorID monitor) const;
+    virtual Viewport get_viewport(MonitorID monitor, WorkspaceID workspace) const;
+    virtual MonitorID get_workspace_monitor(WorkspaceID workspace) const;
+    virtual bool is_workspace_visible(WorkspaceID workspace) const;
+    virtual bool has_monitor_in_direction(Direction direction) const;
+    virtual void focus_monitor_in_direction(Direction direction);
+    virtual Vector2D get_mouse_coords() const;
+    virtual void damage_workspace(WorkspaceID workspace);
+
+    virtual bool overview_enable(WorkspaceID workspace);
+    virtual void overview_set_scale(WorkspaceID workspace, double scale);
+    virtual void overview_disable(WorkspaceID workspace);
+
+    virtual void post_event(EventTopic topic, std::string_view data);
+    // Sends the pending events, called once per event loop iteration
+    void flush_events();
+
+private:
+    bool compiled;
+    LayoutConfig config;
+    ScrollerSizes sizes;
+    EventBus events;
+    wl_event_source *events_flush;
+};
+
+inline WindowID window_id(PHLWINDOW window)
+{
+    return (WindowID)window.get();
+}
+
+inline FullscreenMode to_fullscreen_mode(eFullscreenMode mode)
+{
+    switch (mode) {
+    case eFullscreenMode::FSMODE_MAXIMIZED:
+        return FullscreenMode::Maximized;
+    case eFullscreenMode::FSMODE_FULLSCREEN:
+        return FullscreenMode::Fullscreen;
+    default:
+        return FullscreenMode::None;
+    }
+}
+
+// The Hyprland window of an adapter created by the plugin, or nullptr
+inline PHLWINDOW hyprland_window(WindowAdapter *window)
+{
+    return window != nullptr ? static_cast<HyprlandWindow *>(window)->get_window() : nullptr;
+}
+
+#endif // SCROLLER_HYPRLAND_H
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <drm_fourcc.h>
+#include <pango/pangocairo.h>
+
+#include "labels.h"
+
+// Glyphs are rasterised at this size and scaled to the labels
+static const int GLYPH_SIZE = 128;
+
+void JumpLabels::prepare(const std::string &keys, const std::string &font, uint32_t color)
+{
+    if (requested && keys == glyphs.keys && font == glyphs.font && color == glyphs.color)
+        return;
+
+    Glyphs next;
+    next.keys = keys;
+    next.font = font;
+    next.color = color;
+    // Replacing the future waits for a rasterisation still running, which
+    // only happens if the options change twice in a row
+    pending = std::async(std::launch::async, rasterize, next);
+    glyphs.keys = keys;
+    glyphs.font = font;
+    glyphs.color = color;
+    requested = true;
+}
+
+void JumpLabels::finish()
+{
+    if (!pending.valid())
+        return;
+    // Only waits if the first jump comes right after a change
+    glyphs = pending.get();
+    textures.clear();
+    uploaded = false;
+}
+
+double JumpLabels::get_aspect()
+{
+    finish();
+    return static_cast<double>(glyphs.width) / glyphs.height;
+}
+
+SP<CTexture> JumpLabels::get_glyph(char key)
+{
+    finish();
+    if (!uploaded) {
+        for (auto &pixels : glyphs.pixels) {
+            textures.push_back(makeShared<CTexture>(DRM_FORMAT_ARGB8888, pixels.data(), glyphs.stride,
+                                                    Vector2D(glyphs.width, glyphs.height)));
+        }
+        // The textures have their copy
+        glyphs.pixels.clear();
+        uploaded = true;
+    }
+    const auto index = glyphs.keys.find(key);
+    if (index == std::string::npos || index >= textures.size())
+        return nullptr;
+    return textures[index];
+}
+
+// Runs in a worker thread: only pango and cairo objects of its own
+JumpLabels::Glyphs JumpLabels::rasterize(Glyphs glyphs)
+{
+    PangoFontMap *font_map = pango_cairo_font_map_new();
+    PangoContext *context = pango_font_map_create_context(font_map);
+    PangoLayout *layout = pango_layout_new(context);
+    PangoFontDescription *description = pango_font_description_from_string(glyphs.font.c_str());
+    pango_font_description_set_absolute_size(description, GLYPH_SIZE * PANGO_SCALE);
+    pango_layout_set_font_description(layout, description);
+    pango_font_description_free(description);
+
+    // Every cell fits the largest glyph
+    glyphs.width = 1;
+    glyphs.height = 1;
+    for (char key : glyphs.keys) {
+        int width, height;
+        pango_layout_set_text(layout, &key, 1);
+        pango_layout_get_pixel_size(layout, &width, &height);
+        glyphs.width = std::max(glyphs.width, width);
+        glyphs.height = std::max(glyphs.height, height);
+    }
+    glyphs.stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, glyphs.width);
+
+    const double a = ((glyphs.color >> 24) & 0xff) / 255.0;
+    const double r = ((glyphs.color >> 16) & 0xff) / 255.0;
+    const double g = ((glyphs.color >> 8) & 0xff) / 255.0;
+    const double b = (glyphs.color & 0xff) / 255.0;
+    glyphs.pixels.clear();
+    for (char key : glyphs.keys) {
+        auto &pixels = glyphs.pixels.emplace_back(static_cast<size_t>(glyphs.stride) * glyphs.height, 0);
+        cairo_surface_t *surface = cairo_image_surface_create_for_data(pixels.data(), CAIRO_FORMAT_ARGB32,
+                                                                      glyphs.width, glyphs.height, glyphs.stride);
+        cairo_t *cairo = cairo_create(surface);
+        pango_cairo_update_layout(cairo, layout);
+        pango_layout_set_text(layout, &key, 1);
+        int width, height;
+        pango_layout_get_pixel_size(layout, &width, &height);
+        cairo_move_to(cairo, 0.5 * (glyphs.width - width), 0.5 * (glyphs.height - height));
+        cairo_set_source_rgba(cairo, r, g, b, a);
+        pango_cairo_show_layout(cairo, layout);
+        cairo_surface_flush(surface);
+        cairo_destroy(cairo);
+        cairo_surface_destroy(surface);
+    }
+
+    g_object_unref(layout);
+    g_object_unref(context);
+    g_object_unref(font_map);
+    return glyphs;
+}
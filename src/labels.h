@@ -0,0 +1,57 @@
+#ifndef SCROLLER_LABELS_H
+#define SCROLLER_LABELS_H
+
+#include <hyprland/src/render/Texture.hpp>
+
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+
+// Glyphs of the jump label keys. They are rasterised once per font, colour
+// and set of keys, in the background when those options change, and
+// uploaded as textures the first time jump mode draws them. Labels are then
+// composed from one quad per key, in glyph cells of the same size.
+//
+// Each glyph has its own texture instead of sharing an atlas, because
+// Hyprland's texture pass elements always draw whole textures.
+class JumpLabels {
+public:
+    JumpLabels() : requested(false), uploaded(false) {}
+
+    // Starts rasterising the glyphs of keys if anything changed. color is
+    // 0xAARRGGBB.
+    void prepare(const std::string &keys, const std::string &font, uint32_t color);
+
+    // Width over height of the glyph cells
+    double get_aspect();
+    // Texture of the glyph of key, nullptr if it isn't one of the keys.
+    // Must be called with the renderer's context current.
+    SP<CTexture> get_glyph(char key);
+
+private:
+    struct Glyphs {
+        std::string keys;
+        std::string font;
+        uint32_t color = 0;
+        int width = 1;
+        int height = 1;
+        int stride = 0;
+        // ARGB8888, one image per key
+        std::vector<std::vector<uint8_t>> pixels;
+    };
+
+    static Glyphs rasterize(Glyphs glyphs);
+    // Takes the result of the background rasterisation, if there is one
+    void finish();
+
+    // Keys, font and colour are the latest requested, the images those of
+    // the last finished rasterisation
+    Glyphs glyphs;
+    std::future<Glyphs> pending;
+    std::vector<SP<CTexture>> textures;
+    bool requested;
+    bool uploaded;
+};
+
+#endif // SCROLLER_LABELS_H
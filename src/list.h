@@ -48,6 +48,26 @@ public:
     size_t size() const { return m_size; }
     bool empty() const { return m_size == 0; }
 
+    // Linear, used by consistency checks
+    bool contains(const ListNode<T> *it) const {
+        for (auto node = m_first; node != nullptr; node = node->m_next) {
+            if (node == it)
+                return true;
+        }
+        return false;
+    }
+    // Links in both directions and size agree
+    bool is_valid() const {
+        size_t count = 0;
+        const ListNode<T> *prev = nullptr;
+        for (auto node = m_first; node != nullptr; node = node->m_next) {
+            if (node->m_prev != prev || ++count > m_size)
+                return false;
+            prev = node;
+        }
+        return prev == m_last && count == m_size;
+    }
+
     void push_back(T value) {
         emplace_after(m_last, value);
     }
@@ -1,19 +1,32 @@
 #include <hyprland/src/config/ConfigManager.hpp>
+#include <hyprland/src/debug/HyprCtl.hpp>
+#include <hyprland/src/managers/LayoutManager.hpp>
 #include <hyprland/src/plugins/PluginAPI.hpp>
+#include <hyprutils/string/VarList.hpp>
 #include <hyprlang.hpp>
 
 #include "dispatchers.h"
 #include "scroller.h"
+#include "stats.h"
 
 HANDLE PHANDLE = nullptr;
 std::unique_ptr<ScrollerLayout> g_ScrollerLayout;
 
+// hyprctl [-j] scroller <request>
+static std::string hyprctl_scroller(eHyprCtlOutputFormat format, std::string request) {
+    CVarList args(request, 0, ' ');
+    if (args[1] == "stats")
+        return g_ScrollerLayout->stats(format == eHyprCtlOutputFormat::FORMAT_JSON);
+    return "usage: hyprctl [-j] scroller stats\n";
+}
+
 APICALL EXPORT std::string PLUGIN_API_VERSION() {
     return HYPRLAND_API_VERSION;
 }
 
 APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     PHANDLE = handle;
+    layout_stats.init_begin();
 
     const std::string HASH = __hyprland_api_get_hash();
 
@@ -27,6 +40,7 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     HyprlandAPI::addLayout(PHANDLE, "scroller", g_ScrollerLayout.get());
 
     dispatchers::addDispatchers();
+    HyprlandAPI::registerHyprCtlCommand(PHANDLE, SHyprCtlCommand{ .name = "scroller", .exact = false, .fn = hyprctl_scroller });
 
     // one value out of: { onesixth, onefourth, onethird, onehalf (default), twothirds, floating, maximized }
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:scroller:column_default_width", Hyprlang::STRING{"onehalf"});
@@ -36,6 +50,8 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:scroller:focus_wrap", Hyprlang::INT{1});
     // 0, inf
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:scroller:focus_edge_ms", Hyprlang::INT{400});
+    // 0, inf
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:scroller:focus_hover_ms", Hyprlang::INT{0});
     // 0, 1
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:scroller:cyclesize_wrap", Hyprlang::INT{1});
     // 0, 1
@@ -85,7 +101,21 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:scroller:jump_labels_color", Hyprlang::INT{0x80159e30});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:scroller:jump_labels_keys", Hyprlang::STRING{"1234"});
 
-    HyprlandAPI::reloadConfig();
+    // Record layout operations to this file from the moment the layout is enabled
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:scroller:record", Hyprlang::STRING{""});
+    // 0, 1: keep a snapshot of the layout to restore it after a plugin reload or restart
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:scroller:snapshot", Hyprlang::INT{1});
+    // 0, 1: lay out rows and move the focus once the event loop is idle, when windows open or close
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:scroller:defer_layout", Hyprlang::INT{0});
+
+    // No config reload: it would re-parse everything and relayout every
+    // monitor. Values are compiled when the layout is enabled or first uses
+    // them, and again on every configReloaded event. Hyprland parsed
+    // general:layout before the layout existed, so switch to it here.
+    static auto const *LAYOUT = (Hyprlang::STRING const *)HyprlandAPI::getConfigValue(PHANDLE, "general:layout")->getDataStaticPtr();
+    if (std::string(*LAYOUT) == "scroller" && g_pLayoutManager->getCurrentLayout() != g_ScrollerLayout.get())
+        g_pLayoutManager->switchToLayout("scroller");
+    layout_stats.init_end();
 
     return {"hyprscroller", "scrolling window layout", "dawser", "1.0"};
 }
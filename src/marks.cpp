@@ -0,0 +1,358 @@
+#include <algorithm>
+#include <format>
+
+#include "marks.h"
+
+// Marks
+void Marks::reset()
+{
+    marks.clear();
+    windows.clear();
+    post_mark_event(0);
+}
+
+void Marks::add(WindowID window, const std::string &name)
+{
+    const auto [mark, added] = marks.try_emplace(name, window);
+    if (!added) {
+        if (mark->second == window)
+            unindex(window, mark->first);
+        else
+            unindex(mark->second, mark->first);
+        mark->second = window;
+    }
+    windows[window].push_back(&mark->first);
+    post_mark_event(window);
+}
+
+void Marks::del(const std::string &name, WindowID focused)
+{
+    const auto mark = marks.find(name);
+    if (mark != marks.end()) {
+        const WindowID window = mark->second;
+        unindex(window, mark->first);
+        marks.erase(mark);
+        if (window == focused)
+            post_mark_event(window);
+    }
+}
+
+void Marks::remove(WindowID window)
+{
+    const auto names = windows.find(window);
+    if (names == windows.end())
+        return;
+    for (auto name : names->second) {
+        marks.erase(marks.find(*name));
+    }
+    windows.erase(names);
+}
+
+void Marks::unindex(WindowID window, const std::string &name)
+{
+    const auto names = windows.find(window);
+    if (names == windows.end())
+        return;
+    std::erase(names->second, &name);
+    if (names->second.empty())
+        windows.erase(names);
+}
+
+WindowID Marks::visit(const std::string &name) const
+{
+    const auto mark = marks.find(name);
+    return mark != marks.end() ? mark->second : 0;
+}
+
+void Marks::post_mark_event(WindowID window)
+{
+    const auto names = windows.find(window);
+    if (names != windows.end()) {
+        adapter->post_formatted_event(EventTopic::Mark, "mark, 1, {}", *names->second.back());
+        return;
+    }
+    adapter->post_event(EventTopic::Mark, "mark, 0, ");
+}
+
+void Marks::save(std::vector<SnapshotMark> &saved) const
+{
+    saved.clear();
+    for (const auto &mark : marks) {
+        saved.push_back({ mark.first, mark.second });
+    }
+}
+
+void Marks::restore(const std::vector<SnapshotMark> &saved, const std::unordered_map<WindowID, WindowID> &ids)
+{
+    for (const auto &mark : saved) {
+        const auto id = ids.find(mark.window);
+        if (id != ids.end())
+            add(id->second, mark.name);
+    }
+}
+
+std::string Marks::check() const
+{
+    size_t indexed = 0;
+    for (const auto &names : windows) {
+        if (names.second.empty())
+            return std::format("marks: empty index for window {}", names.first);
+        for (auto name : names.second) {
+            const auto mark = marks.find(*name);
+            if (mark == marks.end() || &mark->first != name || mark->second != names.first)
+                return std::format("marks: window {} has a wrong mark", names.first);
+        }
+        indexed += names.second.size();
+    }
+    if (indexed != marks.size())
+        return std::format("marks: {} marks, {} indexed", marks.size(), indexed);
+    return "";
+}
+
+// Trail
+void Trail::erase(ListNode<WindowID> *win)
+{
+    if (win == active)
+        active = active != marks.last() ? active->next() : active->prev();
+    nodes.erase(win->data());
+    marks.erase(win);
+}
+
+bool Trail::toggle(WindowID window)
+{
+    const auto node = nodes.find(window);
+    if (node != nodes.end()) {
+        erase(node->second);
+        return false;
+    }
+    if (active == nullptr) {
+        marks.push_back(window);
+        active = marks.first();
+    } else {
+        marks.insert_after(active, window);
+        active = active->next();
+    }
+    nodes[window] = active;
+    return true;
+}
+
+void Trail::remove_window(WindowID window)
+{
+    const auto node = nodes.find(window);
+    if (node != nodes.end())
+        erase(node->second);
+}
+
+void Trail::next()
+{
+    if (active == nullptr)
+        return;
+    active = active == marks.last() ? marks.first() : active->next();
+}
+
+void Trail::prev()
+{
+    if (active == nullptr)
+        return;
+    active = active == marks.first() ? marks.last() : active->prev();
+}
+
+// Trails
+Trails::~Trails()
+{
+    for (auto trail = trails.first(); trail != nullptr; trail = trail->next()) {
+        delete trail->data();
+    }
+    active = nullptr;
+    post_trailmark_event(0);
+    post_trail_event();
+}
+
+void Trails::remove_window(WindowID window)
+{
+    const auto in = windows.find(window);
+    if (in == windows.end())
+        return;
+    for (auto trail : in->second) {
+        trail->remove_window(window);
+    }
+    windows.erase(in);
+    post_trail_event();
+}
+
+void Trails::unindex(Trail *trail)
+{
+    for (auto win = trail->marks.first(); win != nullptr; win = win->next()) {
+        unindex(win->data(), trail);
+    }
+}
+
+void Trails::unindex(WindowID window, Trail *trail)
+{
+    const auto in = windows.find(window);
+    if (in == windows.end())
+        return;
+    std::erase(in->second, trail);
+    if (in->second.empty())
+        windows.erase(in);
+}
+
+void Trails::trail_new()
+{
+    trails.push_back(new Trail(counter++));
+    active = trails.last();
+    post_trail_event();
+}
+
+void Trails::trail_next()
+{
+    active = active == trails.last() ? trails.first() : active->next();
+    post_trail_event();
+}
+
+void Trails::trail_prev()
+{
+    active = active == trails.first() ? trails.last() : active->prev();
+    post_trail_event();
+}
+
+void Trails::trail_delete()
+{
+    if (active == nullptr)
+        return;
+    auto act = active == trails.first() ? active->next() : active->prev();
+    unindex(active->data());
+    delete active->data();
+    trails.erase(active);
+    active = act;
+    post_trail_event();
+}
+
+void Trails::trail_clear()
+{
+    if (active == nullptr)
+        return;
+    unindex(active->data());
+    active->data()->clear();
+    post_trail_event();
+}
+
+void Trails::trailmark_toggle(WindowID window)
+{
+    if (active == nullptr) {
+        trail_new();
+    }
+    if (active->data()->toggle(window))
+        windows[window].push_back(active->data());
+    else
+        unindex(window, active->data());
+    post_trailmark_event(window);
+    post_trail_event();
+}
+
+void Trails::trailmark_next()
+{
+    if (active == nullptr)
+        return;
+    active->data()->next();
+}
+
+void Trails::trailmark_prev()
+{
+    if (active == nullptr)
+        return;
+    active->data()->prev();
+}
+
+void Trails::post_trail_event()
+{
+    adapter->post_formatted_event(EventTopic::Trail, "trail, {}, {}", get_active_number(), get_active_size());
+}
+
+void Trails::post_trailmark_event(WindowID window)
+{
+    const bool marked = active != nullptr && active->data()->is_marked(window);
+    adapter->post_formatted_event(EventTopic::TrailMark, "trailmark, {}", marked ? 1 : 0);
+}
+
+void Trails::save(Snapshot &snapshot) const
+{
+    snapshot.trails.clear();
+    snapshot.active_trail = -1;
+    for (auto trail = trails.first(); trail != nullptr; trail = trail->next()) {
+        if (trail == active)
+            snapshot.active_trail = snapshot.trails.size();
+        const Trail *t = trail->data();
+        SnapshotTrail &saved = snapshot.trails.emplace_back();
+        saved.active = t->active != nullptr ? t->active->data() : 0;
+        t->get_windows(saved.windows);
+    }
+}
+
+void Trails::restore(const Snapshot &snapshot, const std::unordered_map<WindowID, WindowID> &ids)
+{
+    for (auto trail = trails.first(); trail != nullptr; trail = trail->next()) {
+        delete trail->data();
+    }
+    trails.clear();
+    windows.clear();
+    active = nullptr;
+    counter = 0;
+
+    for (size_t i = 0; i < snapshot.trails.size(); ++i) {
+        const SnapshotTrail &saved = snapshot.trails[i];
+        Trail *trail = new Trail(counter++);
+        trails.push_back(trail);
+        if (static_cast<int32_t>(i) == snapshot.active_trail)
+            active = trails.last();
+        ListNode<WindowID> *trail_active = nullptr;
+        for (auto window : saved.windows) {
+            const auto id = ids.find(window);
+            if (id == ids.end() || trail->is_marked(id->second))
+                continue;
+            trail->toggle(id->second);
+            windows[id->second].push_back(trail);
+            if (window == saved.active)
+                trail_active = trail->active;
+        }
+        if (trail_active != nullptr)
+            trail->active = trail_active;
+    }
+    if (active == nullptr)
+        active = trails.last();
+    post_trail_event();
+}
+
+std::string Trails::check() const
+{
+    if (!trails.is_valid())
+        return "trails: broken list";
+    if ((active == nullptr) != trails.empty() || (active != nullptr && !trails.contains(active)))
+        return "trails: active is not a trail";
+    for (auto trail = trails.first(); trail != nullptr; trail = trail->next()) {
+        const Trail *t = trail->data();
+        if (!t->marks.is_valid())
+            return std::format("trail {}: broken list", t->number);
+        if ((t->active == nullptr) != t->marks.empty() || (t->active != nullptr && !t->marks.contains(t->active)))
+            return std::format("trail {}: active is not a trailmark", t->number);
+        if (t->nodes.size() != t->marks.size())
+            return std::format("trail {}: {} trailmarks, {} indexed", t->number, t->marks.size(), t->nodes.size());
+        for (auto win = t->marks.first(); win != nullptr; win = win->next()) {
+            const auto node = t->nodes.find(win->data());
+            if (node == t->nodes.end() || node->second != win)
+                return std::format("trail {}: window {} has a wrong node", t->number, win->data());
+            const auto in = windows.find(win->data());
+            if (in == windows.end() || std::find(in->second.begin(), in->second.end(), t) == in->second.end())
+                return std::format("trail {}: window {} is not indexed", t->number, win->data());
+        }
+    }
+    for (const auto &in : windows) {
+        if (in.second.empty())
+            return std::format("trails: empty index for window {}", in.first);
+        for (auto t : in.second) {
+            if (!t->is_marked(in.first))
+                return std::format("trails: window {} indexed in trail {}, which doesn't have it", in.first, t->number);
+        }
+    }
+    return "";
+}
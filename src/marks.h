@@ -0,0 +1,164 @@
+#ifndef SCROLLER_MARKS_H
+#define SCROLLER_MARKS_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "adapter.h"
+#include "list.h"
+#include "snapshot.h"
+
+// Marks and trails only store window ids. The layout removes windows from
+// them when they are closed, and resolves ids to windows when visiting.
+// A window id of 0 means no window.
+//
+// Both keep reverse indexes from windows to their marks and trails, so focus
+// changes and closing windows don't depend on how many there are.
+
+class Marks {
+public:
+    Marks(LayoutAdapter *adapter) : adapter(adapter) {}
+    ~Marks() {}
+    void reset();
+    // Add a mark with name for window, overwriting any existing one with that name
+    void add(WindowID window, const std::string &name);
+    // focused is the window with focus, to update its mark state
+    void del(const std::string &name, WindowID focused);
+    // Remove window from list of marks (used when a window gets deleted)
+    void remove(WindowID window);
+    // If the mark exists, returns that window, otherwise 0
+    WindowID visit(const std::string &name) const;
+
+    // Every marked window
+    void get_windows(std::vector<WindowID> &windows) const {
+        for (const auto &mark : marks) {
+            windows.push_back(mark.second);
+        }
+    }
+
+    // Posts the last mark added to window
+    void post_mark_event(WindowID window);
+
+    // Snapshots (see snapshot.h). restore() adds the saved marks of the
+    // windows in ids.
+    void save(std::vector<SnapshotMark> &saved) const;
+    void restore(const std::vector<SnapshotMark> &saved, const std::unordered_map<WindowID, WindowID> &ids);
+    // Structural checks for the headless tools: empty if consistent
+    std::string check() const;
+
+private:
+    // Removes name from the index of window
+    void unindex(WindowID window, const std::string &name);
+
+    LayoutAdapter *adapter;
+    std::unordered_map<std::string, WindowID> marks;
+    // Names of the marks of each window, in the order they were added. They
+    // point to the keys of marks, which don't move while they are in the map.
+    std::unordered_map<WindowID, std::vector<const std::string *>> windows;
+};
+
+class Trail {
+protected:
+    Trail(int number) : number(number), active(nullptr) {}
+    ~Trail() {}
+
+    // Returns true if window is now in the trail
+    bool toggle(WindowID window);
+    void remove_window(WindowID window);
+    void next();
+    void prev();
+    void clear() {
+        marks.clear();
+        nodes.clear();
+        active = nullptr;
+    }
+    bool is_marked(WindowID window) const {
+        return nodes.contains(window);
+    }
+    void get_windows(std::vector<WindowID> &windows) const {
+        for (auto win = marks.first(); win != nullptr; win = win->next()) {
+            windows.push_back(win->data());
+        }
+    }
+
+private:
+    friend class Trails;
+
+    // Removes win, moving active to a neighbor if it was the active one
+    void erase(ListNode<WindowID> *win);
+
+    int number;
+    ListNode<WindowID> *active;
+    List<WindowID> marks;
+    // Node of each window in marks
+    std::unordered_map<WindowID, ListNode<WindowID> *> nodes;
+};
+
+class Trails {
+public:
+    Trails(LayoutAdapter *adapter) : adapter(adapter), counter(0), active(nullptr) {}
+    ~Trails();
+    void remove_window(WindowID window);
+
+    size_t get_active_size() const {
+        return active ? active->data()->marks.size() : 0;
+    }
+    int get_active_number() const {
+        return active ? active->data()->number : -1;
+    }
+    bool get_active_marked(WindowID window) const {
+        return active ? active->data()->is_marked(window) : false;
+    }
+    // Active window of the active trail, or 0
+    WindowID get_active() const {
+        if (active == nullptr || active->data()->active == nullptr)
+            return 0;
+        return active->data()->active->data();
+    }
+    // Windows of the active trail, for trail_toselection
+    void get_active_windows(std::vector<WindowID> &windows) const {
+        if (active != nullptr)
+            active->data()->get_windows(windows);
+    }
+    void trail_new();
+    void trail_next();
+    void trail_prev();
+    void trail_delete();
+    void trail_clear();
+
+    void trailmark_toggle(WindowID window);
+    void trailmark_next();
+    void trailmark_prev();
+
+    void post_trail_event();
+    void post_trailmark_event(WindowID window);
+
+    // Snapshots (see snapshot.h). restore() replaces every trail with the
+    // saved ones, keeping the windows in ids.
+    void save(Snapshot &snapshot) const;
+    void restore(const Snapshot &snapshot, const std::unordered_map<WindowID, WindowID> &ids);
+
+    // Windows in any trail
+    void get_windows(std::vector<WindowID> &windows) const {
+        for (auto trail = trails.first(); trail != nullptr; trail = trail->next()) {
+            trail->data()->get_windows(windows);
+        }
+    }
+    // Structural checks for the headless tools: empty if consistent
+    std::string check() const;
+
+private:
+    // Removes trail from the index of every window in it
+    void unindex(Trail *trail);
+    void unindex(WindowID window, Trail *trail);
+
+    LayoutAdapter *adapter;
+    int counter;
+    ListNode<Trail *> *active;
+    List<Trail *> trails;
+    // Trails each window is in
+    std::unordered_map<WindowID, std::vector<Trail *>> windows;
+};
+
+#endif // SCROLLER_MARKS_H
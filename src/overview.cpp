@@ -223,7 +223,6 @@ static PHLMONITOR hookGetMonitorFromVector(void *thisptr, const Vector2D& point)
 }
 
 static void hookRenderMonitor(void *thisptr, PHLMONITOR monitor) {
-
     WORKSPACEID workspace = monitor->activeSpecialWorkspaceID();
     if (!workspace)
         workspace = monitor->activeWorkspaceID();
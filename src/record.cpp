@@ -0,0 +1,145 @@
+#include <limits>
+
+#include "record.h"
+
+Recorder recorder;
+
+static bool same_box(const Box &a, const Box &b)
+{
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+bool Recorder::start(const std::string &path)
+{
+    stop();
+    file.open(path, std::ios::out | std::ios::app);
+    if (!file.is_open())
+        return false;
+    // Doubles must survive the round trip for the replay to be exact
+    file.precision(std::numeric_limits<double>::max_digits10);
+    has_config = false;
+    last_sizes.clear();
+    last_monitors.clear();
+    last_active_monitor = -1;
+    last_viewports.clear();
+    last_workspaces.clear();
+    last_mouse = Vector2D();
+    op("record", VERSION);
+    return true;
+}
+
+void Recorder::stop()
+{
+    if (!file.is_open())
+        return;
+    op("stop");
+    file.close();
+}
+
+void Recorder::flush()
+{
+    if (file.is_open())
+        file.flush();
+}
+
+void Recorder::window_open(WorkspaceID workspace, const WindowAdapter *window,
+                           const std::vector<std::pair<std::string, std::string>> &rules)
+{
+    if (!file.is_open())
+        return;
+    const Extents reserved = window->get_reserved_area();
+    file << "open";
+    put(workspace);
+    put(window->get_id());
+    put(window->get_monitor_name());
+    put(reserved.top_left);
+    put(reserved.bottom_right);
+    put(rules.size());
+    for (const auto &rule : rules) {
+        put(rule.first);
+        put(rule.second);
+    }
+    file << '\n';
+}
+
+void Recorder::config(const LayoutConfig &config)
+{
+    if (!file.is_open())
+        return;
+    if (has_config && config == last_config)
+        return;
+    has_config = true;
+    last_config = config;
+    op("config", config.center_row_if_space_available, config.center_active_column,
+       config.center_active_window, config.cyclesize_closest, config.overview_scale_content);
+}
+
+void Recorder::sizes(const std::string &window_default_height, const std::string &column_default_width,
+                     const std::string &window_heights, const std::string &column_widths,
+                     const std::string &monitor_options, bool cyclesize_wrap)
+{
+    if (!file.is_open())
+        return;
+    std::vector<std::string> sizes = { window_default_height, column_default_width, window_heights,
+                                       column_widths, monitor_options, cyclesize_wrap ? "1" : "0" };
+    if (sizes == last_sizes)
+        return;
+    last_sizes = std::move(sizes);
+    op("sizes", window_default_height, column_default_width, window_heights, column_widths,
+       monitor_options, cyclesize_wrap);
+}
+
+void Recorder::monitor(MonitorID monitor, const std::string &name, const Box &full)
+{
+    if (!file.is_open())
+        return;
+    const auto last = last_monitors.find(monitor);
+    if (last != last_monitors.end() && last->second.first == name && same_box(last->second.second, full))
+        return;
+    last_monitors[monitor] = { name, full };
+    op("monitor", monitor, name, full);
+}
+
+void Recorder::active_monitor(MonitorID monitor)
+{
+    if (!file.is_open() || monitor == last_active_monitor)
+        return;
+    last_active_monitor = monitor;
+    op("activemonitor", monitor);
+}
+
+void Recorder::viewport(MonitorID monitor, WorkspaceID workspace, const Viewport &viewport)
+{
+    if (!file.is_open())
+        return;
+    const auto last = last_viewports.find({ monitor, workspace });
+    if (last != last_viewports.end() && same_box(last->second.full, viewport.full) &&
+        same_box(last->second.max, viewport.max) && last->second.gap == viewport.gap)
+        return;
+    last_viewports[{ monitor, workspace }] = viewport;
+    op("viewport", monitor, workspace, viewport.full, viewport.max, viewport.gap);
+}
+
+void Recorder::workspace(WorkspaceID workspace, MonitorID monitor, bool visible)
+{
+    if (!file.is_open())
+        return;
+    const auto last = last_workspaces.find(workspace);
+    if (last != last_workspaces.end() && last->second.first == monitor && last->second.second == visible)
+        return;
+    last_workspaces[workspace] = { monitor, visible };
+    op("workspace", workspace, monitor, visible);
+}
+
+void Recorder::monitor_in_direction(Direction direction, bool exists)
+{
+    op("monitorindirection", direction, exists);
+}
+
+void Recorder::mouse(const Vector2D &coords)
+{
+    if (!file.is_open() || coords == last_mouse)
+        return;
+    last_mouse = coords;
+    op("mouse", coords);
+}
@@ -0,0 +1,93 @@
+#ifndef SCROLLER_RECORD_H
+#define SCROLLER_RECORD_H
+
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "adapter.h"
+
+// Opt-in session recorder. It appends every dispatcher call and layout
+// callback (operations), and the compositor state the layout reads while
+// running them (inputs), to a text file, one record per line:
+//
+//   <name> <arguments...>
+//
+// Strings are quoted, enums are written as integers. Inputs are only written
+// when they change, and belong to the operation before them: the replayer
+// (tools/replay.cpp) applies them before running that operation.
+class Recorder {
+public:
+    static constexpr int VERSION = 6;
+
+    Recorder() {}
+    ~Recorder() { stop(); }
+
+    // Appends to path
+    bool start(const std::string &path);
+    void stop();
+    bool is_recording() const { return file.is_open(); }
+    // Records are buffered until the buffer fills, this is called, or the
+    // recording stops
+    void flush();
+
+    // Operations
+    template <typename... Args>
+    void op(const char *name, const Args &...args) {
+        if (!file.is_open())
+            return;
+        file << name;
+        (put(args), ...);
+        file << '\n';
+    }
+    // A new window, with its geometry inputs and "plugin:scroller:*" rules
+    void window_open(WorkspaceID workspace, const WindowAdapter *window,
+                     const std::vector<std::pair<std::string, std::string>> &rules);
+
+    // Inputs
+    void config(const LayoutConfig &config);
+    void sizes(const std::string &window_default_height, const std::string &column_default_width,
+               const std::string &window_heights, const std::string &column_widths,
+               const std::string &monitor_options, bool cyclesize_wrap);
+    void monitor(MonitorID monitor, const std::string &name, const Box &full);
+    void active_monitor(MonitorID monitor);
+    void viewport(MonitorID monitor, WorkspaceID workspace, const Viewport &viewport);
+    void workspace(WorkspaceID workspace, MonitorID monitor, bool visible);
+    void monitor_in_direction(Direction direction, bool exists);
+    void mouse(const Vector2D &coords);
+
+private:
+    template <typename T>
+    void put(const T &value) {
+        if constexpr (std::is_enum_v<T>)
+            file << ' ' << static_cast<int>(value);
+        else if constexpr (std::is_same_v<T, std::string> || std::is_convertible_v<T, const char *>)
+            file << ' ' << std::quoted(std::string(value));
+        else if constexpr (std::is_same_v<T, Vector2D>)
+            file << ' ' << value.x << ' ' << value.y;
+        else if constexpr (std::is_same_v<T, Box>)
+            file << ' ' << value.x << ' ' << value.y << ' ' << value.w << ' ' << value.h;
+        else
+            file << ' ' << value;
+    }
+
+    std::ofstream file;
+
+    // Last recorded inputs
+    bool has_config = false;
+    LayoutConfig last_config;
+    std::vector<std::string> last_sizes;
+    std::map<MonitorID, std::pair<std::string, Box>> last_monitors;
+    MonitorID last_active_monitor = -1;
+    std::map<std::pair<MonitorID, WorkspaceID>, Viewport> last_viewports;
+    std::map<WorkspaceID, std::pair<MonitorID, bool>> last_workspaces;
+    Vector2D last_mouse;
+};
+
+extern Recorder recorder;
+
+#endif // SCROLLER_RECORD_H
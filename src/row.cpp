@@ -1,27 +1,22 @@
-#include <hyprland/src/config/ConfigValue.hpp>
-#include <hyprland/src/managers/EventManager.hpp>
-#include <hyprland/src/plugins/PluginAPI.hpp>
-#include <hyprland/src/render/Renderer.hpp>
-#include <hyprland/src/managers/input/InputManager.hpp>
+#include <cmath>
+#include <format>
+#include <sstream>
 
 #include "common.h"
-#include "functions.h"
 #include "row.h"
-#include "overview.h"
+#include "sizes.h"
+#include "stats.h"
+#include "trace.h"
 
-extern HANDLE PHANDLE;
-extern Overview *overviews;
-extern std::function<SDispatchResult(std::string)> orig_moveFocusTo;
-extern ScrollerSizes scroller_sizes;
-
-Row::Row(WORKSPACEID workspace)
-    : workspace(workspace), overview(false),
+Row::Row(WorkspaceID workspace, LayoutAdapter *adapter)
+    : workspace(workspace), adapter(adapter), overview(false), loading(false), stale(false),
+      preoverview_fsmode(FullscreenMode::None), gap(0),
       reorder(Reorder::Auto), pinned(nullptr), active(nullptr)
 {
-    post_event("overview");
-    const auto PMONITOR = g_pCompositor->m_pLastMonitor.lock();
-    set_mode(scroller_sizes.get_mode(PMONITOR));
-    update_sizes(PMONITOR);
+    post_event(EventTopic::Overview);
+    const MonitorID monitor = adapter->get_workspace_monitor(workspace);
+    set_mode(adapter->get_sizes().get_mode(adapter->get_monitor_name(monitor)));
+    update_sizes(monitor);
 }
 
 Row::~Row()
@@ -85,51 +80,58 @@ void Row::find_auto_insert_point(Mode &new_mode, ListNode<Column *> *&new_active
     }
 }
 
-void Row::add_active_window(PHLWINDOW window)
+void Row::add_active_window(WindowAdapter *window)
+{
+    insert_window(window, nullptr);
+}
+
+void Row::attach_window(Window *window)
+{
+    insert_window(window->get_window(), window);
+}
+
+void Row::insert_window(WindowAdapter *window, Window *moved)
 {
     bool overview_on = overview;
     if (overview)
         toggle_overview();
 
-    eFullscreenMode fsmode;
-    if (active != nullptr) {
+    FullscreenMode fsmode;
+    if (active != nullptr && !loading) {
         auto awindow = get_active_window();
-        fsmode = window_fullscreen_state(awindow);
-        if (fsmode != eFullscreenMode::FSMODE_NONE) {
-            toggle_window_fullscreen_internal(awindow, eFullscreenMode::FSMODE_NONE);
+        fsmode = awindow->get_fullscreen_mode();
+        if (fsmode != FullscreenMode::None) {
+            awindow->toggle_fullscreen(FullscreenMode::None);
         }
     } else {
-        fsmode = eFullscreenMode::FSMODE_NONE;
+        fsmode = FullscreenMode::None;
     }
 
     auto store_mode = mode;
 
     // Evaluate window rules
     auto store_modifier = modifier;
-    for (auto &r: window->m_vMatchedRules) {
-        if (r->szRule.starts_with("plugin:scroller:modemodifier")) {
-            const auto modemodifier = r->szRule.substr(r->szRule.find_first_of(' ') + 1);
-            // params: row|column after|before|end|beginning focus|nofocus
-            std::istringstream iss(modemodifier);
-            std::string arg;
-            while (iss >> arg) {
-                if (arg == "row") {
-                    mode = Mode::Row;
-                } else if (arg == "col" || arg == "column") {
-                    mode = Mode::Column;
-                } else if (arg == "after") {
-                    modifier.set_position(ModeModifier::POSITION_AFTER);
-                } else if (arg == "before") {
-                    modifier.set_position(ModeModifier::POSITION_BEFORE);
-                } else if (arg == "end") {
-                    modifier.set_position(ModeModifier::POSITION_END);
-                } else if (arg == "beg" || arg == "beginning") {
-                    modifier.set_position(ModeModifier::POSITION_BEGINNING);
-                } else if (arg == "focus") {
-                    modifier.set_focus(ModeModifier::FOCUS_FOCUS);
-                } else if (arg == "nofocus") {
-                    modifier.set_focus(ModeModifier::FOCUS_NOFOCUS);
-                }
+    for (const auto &modemodifier : window->get_rules("modemodifier")) {
+        // params: row|column after|before|end|beginning focus|nofocus
+        std::istringstream iss(modemodifier);
+        std::string arg;
+        while (iss >> arg) {
+            if (arg == "row") {
+                mode = Mode::Row;
+            } else if (arg == "col" || arg == "column") {
+                mode = Mode::Column;
+            } else if (arg == "after") {
+                modifier.set_position(ModeModifier::POSITION_AFTER);
+            } else if (arg == "before") {
+                modifier.set_position(ModeModifier::POSITION_BEFORE);
+            } else if (arg == "end") {
+                modifier.set_position(ModeModifier::POSITION_END);
+            } else if (arg == "beg" || arg == "beginning") {
+                modifier.set_position(ModeModifier::POSITION_BEGINNING);
+            } else if (arg == "focus") {
+                modifier.set_focus(ModeModifier::FOCUS_FOCUS);
+            } else if (arg == "nofocus") {
+                modifier.set_focus(ModeModifier::FOCUS_NOFOCUS);
             }
         }
     }
@@ -138,33 +140,56 @@ void Row::add_active_window(PHLWINDOW window)
     find_auto_insert_point(mode, active);
 
     if (active && mode == Mode::Column) {
-        active->data()->add_active_window(window);
-        active->data()->recalculate_col_geometry(calculate_gap_x(active), gap, true);
+        if (moved != nullptr)
+            active->data()->insert_active_window(moved);
+        else
+            active->data()->add_active_window(window);
+        if (can_layout())
+            active->data()->recalculate_col_geometry(calculate_gap_x(active), gap, true);
         if (modifier.get_focus() == ModeModifier::FOCUS_NOFOCUS && store_active != nullptr)
             active = store_active;
     } else {
         auto focus = modifier.get_focus();
+        Column *column;
+        if (moved != nullptr) {
+            // Keeps the window's own width, like an expelled window
+            const StandardSize width = moved->get_width();
+            const double maxw = width == StandardSize::Free ? moved->get_geom_w(Vector2D(gap, gap)) : max.w;
+            column = new Column(moved, width, maxw, this);
+        } else {
+            column = new Column(window, this);
+        }
         auto node = active;
         switch (modifier.get_position()) {
         case ModeModifier::POSITION_AFTER:
         default:
-            node = columns.emplace_after(active, new Column(window, this));
+            node = columns.emplace_after(active, column);
             break;
         case ModeModifier::POSITION_BEFORE:
-            node = columns.emplace_before(active, new Column(window, this));
+            node = columns.emplace_before(active, column);
             break;
         case ModeModifier::POSITION_END:
-            node = columns.emplace_after(columns.last(), new Column(window, this));
+            node = columns.emplace_after(columns.last(), column);
             break;
         case ModeModifier::POSITION_BEGINNING:
-            node = columns.emplace_before(columns.first(), new Column(window, this));
+            node = columns.emplace_before(columns.first(), column);
             break;
         }
+        if (moved != nullptr) {
+            // Next to its neighbours, which helps the heuristic in
+            // recalculate_row_geometry()
+            if (node->prev() != nullptr)
+                column->set_geom_pos(node->prev()->data()->get_geom_x() + node->prev()->data()->get_geom_w(), max.y);
+            else if (node->next() != nullptr)
+                column->set_geom_pos(node->next()->data()->get_geom_x() - column->get_geom_w(), max.y);
+            else
+                column->set_geom_pos(max.x + 0.5 * (max.w - column->get_geom_w()), max.y);
+        }
         if (focus == ModeModifier::FOCUS_FOCUS || store_active == nullptr)
             active = node;
         else {
             active = store_active;
-            window->m_bNoInitialFocus = true;
+            window->set_no_initial_focus();
         }
 
         reorder = Reorder::Auto;
@@ -173,33 +198,59 @@ void Row::add_active_window(PHLWINDOW window)
     modifier = store_modifier;
     mode = store_mode;
 
-    if (fsmode != eFullscreenMode::FSMODE_NONE) {
-        toggle_window_fullscreen_internal(window, fsmode);
-        force_focus_to_window(window);
+    if (fsmode != FullscreenMode::None) {
+        window->toggle_fullscreen(fsmode);
+        window->force_focus();
     }
     if (overview_on)
         toggle_overview();
 }
 
+void Row::end_load(bool animate)
+{
+    loading = false;
+    for (auto c = columns.first(); c != nullptr; c = c->next()) {
+        WindowAdapter *window = c->data()->get_active_window();
+        if (window->get_fullscreen_mode() != FullscreenMode::None) {
+            active = c;
+            break;
+        }
+    }
+    recalculate_row_geometry(animate);
+}
+
 // Remove a window and re-adapt rows and columns, returning
 // true if successful, or false if this is the last row
 // so the layout can remove it.
-bool Row::remove_window(PHLWINDOW window)
+bool Row::remove_window(WindowID window)
+{
+    delete detach_window(window);
+    return !columns.empty();
+}
+
+Window *Row::detach_window(WindowID window)
 {
     bool overview_on = overview;
     if (overview)
         toggle_overview();
 
-    eFullscreenMode fsmode = window_fullscreen_state(window);
-    if (fsmode != eFullscreenMode::FSMODE_NONE) {
-        toggle_window_fullscreen_internal(window, eFullscreenMode::FSMODE_NONE);
+    FullscreenMode fsmode = FullscreenMode::None;
+    for (auto c = columns.first(); c != nullptr; c = c->next()) {
+        Window *win = c->data()->get_window(window);
+        if (win != nullptr) {
+            fsmode = loading ? FullscreenMode::None : win->fullscreen_state();
+            if (fsmode != FullscreenMode::None)
+                win->get_window()->toggle_fullscreen(FullscreenMode::None);
+            break;
+        }
     }
 
     reorder = Reorder::Auto;
+    Window *taken = nullptr;
     for (auto c = columns.first(); c != nullptr; c = c->next()) {
         Column *col = c->data();
         if (col->has_window(window)) {
-            col->remove_window(window);
+            taken = col->take_window(window);
             if (col->size() == 0) {
                 if (c == pinned) {
                     pinned = nullptr;
@@ -214,38 +265,85 @@ bool Row::remove_window(PHLWINDOW window)
                 delete col;
                 columns.erase(c);
                 if (columns.empty()) {
-                    return false;
+                    return taken;
                 } else {
                     recalculate_row_geometry();
                     break;
                 }
             } else {
-                c->data()->recalculate_col_geometry(calculate_gap_x(c), gap, true);
+                if (can_layout())
+                    c->data()->recalculate_col_geometry(calculate_gap_x(c), gap, true);
                 break;
             }
         }
     }
-    if (fsmode != eFullscreenMode::FSMODE_NONE) {
-        PHLWINDOW awindow = get_active_window();
-        toggle_window_fullscreen_internal(awindow, fsmode);
-        force_focus_to_window(awindow);
+    if (fsmode != FullscreenMode::None) {
+        WindowAdapter *awindow = get_active_window();
+        awindow->toggle_fullscreen(fsmode);
+        awindow->force_focus();
     }
     if (overview_on)
         toggle_overview();
 
-    return true;
+    return taken;
 }
 
-void Row::focus_window(PHLWINDOW window)
+bool Row::focus_window(WindowID window, bool scroll)
 {
     for (auto c = columns.first(); c != nullptr; c = c->next()) {
         if (c->data()->has_window(window)) {
+            auto previous = active;
             c->data()->focus_window(window);
             active = c;
-            recalculate_row_geometry();
-            return;
+            // When the full layout would leave the column where it is, the
+            // rest of the row doesn't move either, and only the two columns
+            // need updating. Stale rows, overview, fullscreen and centered
+            // columns always need the full layout.
+            if (stale || overview || c->data()->fullscreen() || get_center_column() ||
+                (scroll && !keeps_position(c))) {
+                recalculate_row_geometry();
+                return true;
+            }
+            if (!can_layout())
+                return false;
+            LayoutPlan plan;
+            if (previous != nullptr && previous != c && !previous->data()->fullscreen())
+                previous->data()->recalculate_col_geometry(calculate_gap_x(previous), gap, true);
+            c->data()->recalculate_col_geometry(calculate_gap_x(c), gap, true);
+            return false;
         }
     }
+    return false;
+}
+
+bool Row::is_in_viewport(const ListNode<Column *> *column) const
+{
+    const double x = column->data()->get_geom_x();
+    const double w = column->data()->get_geom_w();
+    return x >= max.x && std::round(x + w) <= max.x + max.w;
+}
+
+// Mirrors the cases of recalculate_row_geometry() that leave the active
+// column in place. Pinned columns can be brought back into the viewport,
+// moving the rest.
+bool Row::keeps_position(const ListNode<Column *> *column) const
+{
+    if (!is_in_viewport(column) || pinned != nullptr)
+        return false;
+    if (reorder == Reorder::Lazy)
+        return true;
+    // Reorder::Auto keeps it if a neighbour is in the viewport too, except
+    // the first and last columns of a row that overflows, which go to the edge
+    if ((column->prev() == nullptr || !is_in_viewport(column->prev())) &&
+        (column->next() == nullptr || !is_in_viewport(column->next())))
+        return false;
+    if (column != columns.first() && column != columns.last())
+        return true;
+    double w = 0.0;
+    for (auto col = columns.first(); col != nullptr; col = col->next()) {
+        w += col->data()->get_geom_w();
+    }
+    return std::round(w) < max.w;
 }
 
 bool Row::move_focus(Direction dir, bool focus_wrap)
@@ -288,14 +386,13 @@ bool Row::move_focus(Direction dir, bool focus_wrap)
 bool Row::move_focus_left(bool focus_wrap)
 {
     if (active == columns.first()) {
-        PHLMONITOR monitor = g_pCompositor->getMonitorInDirection('l');
-        if (monitor == nullptr) {
+        if (!adapter->has_monitor_in_direction(Direction::Left)) {
             if (focus_wrap)
                 active = columns.last();
             return true;
         }
 
-        orig_moveFocusTo("l");
+        adapter->focus_monitor_in_direction(Direction::Left);
         return false;
     }
     active = active->prev();
@@ -305,14 +402,13 @@ bool Row::move_focus_left(bool focus_wrap)
 bool Row::move_focus_right(bool focus_wrap)
 {
     if (active == columns.last()) {
-        PHLMONITOR monitor = g_pCompositor->getMonitorInDirection('r');
-        if (monitor == nullptr) {
+        if (!adapter->has_monitor_in_direction(Direction::Right)) {
             if (focus_wrap)
                 active = columns.first();
             return true;
         }
 
-        orig_moveFocusTo("r");
+        adapter->focus_monitor_in_direction(Direction::Right);
         return false;
     }
     active = active->next();
@@ -350,18 +446,19 @@ void Row::resize_active_column(int step)
     if (mode == Mode::Column) {
         active->data()->cycle_size_active_window(step, calculate_gap_x(active), gap);
     } else {
+        const ScrollerSizes &sizes = adapter->get_sizes();
+        const std::string &monitor = adapter->get_monitor_name(adapter->get_active_monitor());
         StandardSize width = active->data()->get_width();
         if (width == StandardSize::Free) {
             // When cycle-resizing from Free mode, move back to closest or default
-            static auto* const *CYCLESIZE_CLOSEST = (Hyprlang::INT* const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:cyclesize_closest")->getDataStaticPtr();
-            if (**CYCLESIZE_CLOSEST) {
+            if (adapter->get_config().cyclesize_closest) {
                 double fraction = active->data()->get_geom_w() / max.w;
-                width = scroller_sizes.get_column_closest_width(g_pCompositor->m_pLastMonitor, fraction, step);
+                width = sizes.get_column_closest_width(monitor, fraction, step);
             } else {
-                width = scroller_sizes.get_column_default_width(get_active_window());
+                width = sizes.get_column_default_width(get_active_window());
             }
         } else {
-            width = scroller_sizes.get_next_column_width(width, step);
+            width = sizes.get_next_column_width(monitor, width, step);
         }
         active->data()->update_width(width, max.w);
         reorder = Reorder::Auto;
@@ -393,6 +490,8 @@ void Row::size_active_column(StandardSize size)
 
 void Row::size_active_column(const std::string &fraction)
 {
+    const ScrollerSizes &sizes = adapter->get_sizes();
+    const std::string &monitor = adapter->get_monitor_name(adapter->get_active_monitor());
     StandardSize size;
     if (std::isdigit(fraction.front())) {
         int index = 0;
@@ -402,11 +501,11 @@ void Row::size_active_column(const std::string &fraction)
             return;
         }
         size = mode == Mode::Row ?
-            size = scroller_sizes.get_column_width(index) : size = scroller_sizes.get_window_height(index);
+            size = sizes.get_column_width(monitor, index) : size = sizes.get_window_height(monitor, index);
     } else {
         StandardSize default_size = mode == Mode::Row ?
-            scroller_sizes.get_column_width(0) : scroller_sizes.get_window_height(0);
-        size = scroller_sizes.get_size_from_string(fraction, default_size);
+            sizes.get_column_width(monitor, 0) : sizes.get_window_height(monitor, 0);
+        size = sizes.get_size_from_string(fraction, default_size);
     }
     size_active_column(size);
 }
@@ -427,7 +526,7 @@ void Row::set_mode(Mode m, bool silent)
 {
     mode = m;
     if (!silent) {
-        post_event("mode");
+        post_event(EventTopic::Mode);
     }
 }
 
@@ -449,17 +548,17 @@ void Row::set_mode_modifier(const ModeModifier &options)
         modifier.set_auto_mode(auto_mode);
         modifier.set_auto_param(options.get_auto_param());
     }
-    auto center_column = options.get_center_column(false);
+    auto center_column = options.get_center_column();
     if (center_column.has_value())
         modifier.set_center_column(center_column.value());
-    auto center_window = options.get_center_window(false);
+    auto center_window = options.get_center_window();
     if (center_window.has_value())
         modifier.set_center_window(center_window.value());
 
-    post_event("mode");
+    post_event(EventTopic::Mode);
 }
 
-ModeModifier Row::get_mode_modifier() const
+const ModeModifier &Row::get_mode_modifier() const
 {
     return modifier;
 }
@@ -529,7 +628,7 @@ void Row::selection_toggle()
     active->data()->selection_toggle();
 }
 
-void Row::selection_set(PHLWINDOWREF window)
+void Row::selection_set(WindowID window)
 {
     for (auto col = columns.first(); col != nullptr; col = col->next()) {
         col->data()->selection_set(window);
@@ -623,8 +722,8 @@ void Row::selection_get(const Row *row, List<Column *> &selection)
                 if (col == active) {
                     active = active != columns.last() ? active->next() : active->prev();
                 }
-                columns.erase(col);
                 delete col->data();
+                columns.erase(col);
             }
         }
         col = next;
@@ -690,16 +789,17 @@ void Row::move_active_window_to_group(const std::string &name)
     for (auto c = columns.first(); c != nullptr; c = c->next()) {
         Column *col = c->data();
         if (col->get_name() == name) {
-            PHLWINDOW window = active->data()->get_active_window();
-            remove_window(window);
+            WindowAdapter *window = active->data()->get_active_window();
+            remove_window(window->get_id());
             col->add_active_window(window);
-            if (!window->isFullscreen())
+            const bool fullscreen = window->get_fullscreen_mode() != FullscreenMode::None;
+            if (!fullscreen && can_layout())
                 col->recalculate_col_geometry(calculate_gap_x(c), gap, true);
             active = c;
-            if (!window->isFullscreen())
+            if (!fullscreen)
                 recalculate_row_geometry();
             else {
-                force_focus_to_window(window);
+                window->force_focus();
             }
             return;
         }
@@ -714,10 +814,10 @@ void Row::move_active_column(Direction dir)
         toggle_overview();
 
     auto window = active->data()->get_active_window();
-    update_relative_cursor_coords(window);
-    eFullscreenMode fsmode = window_fullscreen_state(window);
-    if (fsmode != eFullscreenMode::FSMODE_NONE) {
-        toggle_window_fullscreen_internal(window, eFullscreenMode::FSMODE_NONE);
+    window->update_relative_cursor_coords();
+    FullscreenMode fsmode = window->get_fullscreen_mode();
+    if (fsmode != FullscreenMode::None) {
+        window->toggle_fullscreen(FullscreenMode::None);
     }
 
     switch (dir) {
@@ -759,11 +859,11 @@ void Row::move_active_column(Direction dir)
     reorder = Reorder::Auto;
     recalculate_row_geometry();
 
-    if (fsmode != eFullscreenMode::FSMODE_NONE) {
+    if (fsmode != FullscreenMode::None) {
         window = active->data()->get_active_window();
-        toggle_window_fullscreen_internal(window, fsmode);
+        window->toggle_fullscreen(fsmode);
     }
-    force_focus_to_window(window);
+    window->force_focus();
 
     if (overview_on)
         toggle_overview();
@@ -776,10 +876,10 @@ void Row::move_active_window(Direction dir)
         toggle_overview();
 
     auto window = active->data()->get_active_window();
-    update_relative_cursor_coords(window);
-    eFullscreenMode fsmode = window_fullscreen_state(window);
-    if (fsmode != eFullscreenMode::FSMODE_NONE) {
-        toggle_window_fullscreen_internal(window, eFullscreenMode::FSMODE_NONE);
+    window->update_relative_cursor_coords();
+    FullscreenMode fsmode = window->get_fullscreen_mode();
+    if (fsmode != FullscreenMode::None) {
+        window->toggle_fullscreen(FullscreenMode::None);
     }
 
     switch (dir) {
@@ -845,11 +945,11 @@ void Row::move_active_window(Direction dir)
     // Now the columns are in the right order, recalculate again
     recalculate_row_geometry();
 
-    if (fsmode != eFullscreenMode::FSMODE_NONE) {
+    if (fsmode != FullscreenMode::None) {
         window = active->data()->get_active_window();
-        toggle_window_fullscreen_internal(window, fsmode);
+        window->toggle_fullscreen(fsmode);
     }
-    force_focus_to_window(window);
+    window->force_focus();
 
     if (overview_on)
         toggle_overview();
@@ -889,6 +989,7 @@ void Row::admit_window(AdmitExpelDirection dir)
     if (active->data()->size() == 0) {
         if (active == pinned)
             pinned = nullptr;
+        delete active->data();
         columns.erase(active);
     }
     active = node;
@@ -899,7 +1000,7 @@ void Row::admit_window(AdmitExpelDirection dir)
     reorder = Reorder::Auto;
     recalculate_row_geometry();
 
-    post_event("admitwindow");
+    post_event(EventTopic::AdmitWindow);
 
     if (overview_on)
         toggle_overview();
@@ -947,7 +1048,7 @@ void Row::expel_window(AdmitExpelDirection dir)
     reorder = Reorder::Auto;
     recalculate_row_geometry();
 
-    post_event("expelwindow");
+    post_event(EventTopic::ExpelWindow);
 
     if (overview_on)
         toggle_overview();
@@ -958,64 +1059,57 @@ Vector2D Row::predict_window_size() const
     return Vector2D(0.5 * max.w, max.h);
 }
 
-void Row::post_event(const std::string &event)
+void Row::post_event(EventTopic topic)
 {
-    if (event == "mode") {
+    switch (topic) {
+    case EventTopic::Mode: {
         auto str_mode = mode == Mode::Row ? "row" : "column";
-        g_pEventManager->postEvent(SHyprIPCEvent{"scroller", std::format("mode, {}, {}, {}, {}:{}, {}, {}", str_mode,
+        const LayoutConfig &config = adapter->get_config();
+        adapter->post_formatted_event(topic, "mode, {}, {}, {}, {}:{}, {}, {}", str_mode,
             modifier.get_position_string(), modifier.get_focus_string(), modifier.get_auto_mode_string(), modifier.get_auto_param(),
-            modifier.get_center_column_string(), modifier.get_center_window_string())});
-    } else if (event == "overview") {
-        g_pEventManager->postEvent(SHyprIPCEvent{"scroller", std::format("overview, {}", overview ? 1 : 0)});
-    } else if (event == "admitwindow") {
-        g_pEventManager->postEvent(SHyprIPCEvent{"scroller", "admitwindow"});
-    } else if (event == "expelwindow") {
-        g_pEventManager->postEvent(SHyprIPCEvent{"scroller", "expelwindow"});
+            modifier.get_center_column_string(config.center_active_column),
+            modifier.get_center_window_string(config.center_active_window));
+        break;
+    }
+    case EventTopic::Overview:
+        adapter->post_formatted_event(topic, "overview, {}", overview ? 1 : 0);
+        break;
+    case EventTopic::AdmitWindow:
+        adapter->post_event(topic, "admitwindow");
+        break;
+    case EventTopic::ExpelWindow:
+        adapter->post_event(topic, "expelwindow");
+        break;
+    default:
+        break;
     }
 }
 
 // Returns true/false if columns/windows need to be recalculated
-bool Row::update_sizes(PHLMONITOR monitor)
+bool Row::update_sizes(MonitorID monitor)
 {
-    // for gaps outer
-    static auto PGAPSINDATA = CConfigValue<Hyprlang::CUSTOMTYPE>("general:gaps_in");
-    static auto PGAPSOUTDATA = CConfigValue<Hyprlang::CUSTOMTYPE>("general:gaps_out");
-    auto *const PGAPSIN = (CCssGapData *)(PGAPSINDATA.ptr())->getData();
-    auto *const PGAPSOUT = (CCssGapData *)(PGAPSOUTDATA.ptr())->getData();
-    const auto WORKSPACERULE = g_pConfigManager->getWorkspaceRuleFor(g_pCompositor->getWorkspaceByID(workspace));
-    // For now, support only constant CCssGapData
-    auto gaps_in = WORKSPACERULE.gapsIn.value_or(*PGAPSIN).top;
-    auto gaps_out = WORKSPACERULE.gapsOut.value_or(*PGAPSOUT);
-    const auto SIZE = monitor->vecSize;
-    const auto POS = monitor->vecPosition;
-    const auto TOPLEFT = monitor->vecReservedTopLeft;
-    const auto BOTTOMRIGHT = monitor->vecReservedBottomRight;
-
-    full = Box(POS, SIZE);
-    const Box newmax = Box(POS.x + TOPLEFT.x + gaps_out.left,
-                           POS.y + TOPLEFT.y + gaps_out.top,
-                           SIZE.x - TOPLEFT.x - BOTTOMRIGHT.x - gaps_out.left - gaps_out.right,
-                           SIZE.y - TOPLEFT.y - BOTTOMRIGHT.y - gaps_out.top - gaps_out.bottom);
-    bool changed = gap != gaps_in;
-    gap = gaps_in;
-
-    if (max != newmax)
+    const Viewport viewport = adapter->get_viewport(monitor, workspace);
+    full = viewport.full;
+    bool changed = gap != viewport.gap;
+    gap = viewport.gap;
+
+    if (max != viewport.max)
         changed = true;
 
-    max = newmax;
+    max = viewport.max;
     return changed;
 }
 
-void Row::set_fullscreen_mode_windows(eFullscreenMode mode)
+void Row::set_fullscreen_mode_windows(FullscreenMode mode)
 {
     Column *column = active->data();
     switch (mode) {
-    case eFullscreenMode::FSMODE_NONE:
+    case FullscreenMode::None:
         break;
-    case eFullscreenMode::FSMODE_FULLSCREEN:
+    case FullscreenMode::Fullscreen:
         column->set_active_window_geometry(full);
         break;
-    case eFullscreenMode::FSMODE_MAXIMIZED:
+    case FullscreenMode::Maximized:
         column->set_active_window_geometry(max);
         break;
     default:
@@ -1023,7 +1117,7 @@ void Row::set_fullscreen_mode_windows(eFullscreenMode mode)
     }
 }
 
-void Row::set_fullscreen_mode(PHLWINDOW window, eFullscreenMode cur_mode, eFullscreenMode new_mode)
+void Row::set_fullscreen_mode(WindowID window, FullscreenMode cur_mode, FullscreenMode new_mode)
 {
     reorder = Reorder::Auto;
     Window *win = nullptr;
@@ -1034,16 +1128,16 @@ void Row::set_fullscreen_mode(PHLWINDOW window, eFullscreenMode cur_mode, eFulls
     }
     if (win != nullptr) {
         switch (new_mode) {
-        case eFullscreenMode::FSMODE_NONE:
+        case FullscreenMode::None:
             win->pop_fullscreen_geom();
             break;
-        case eFullscreenMode::FSMODE_FULLSCREEN:
-            if (cur_mode == eFullscreenMode::FSMODE_NONE)
+        case FullscreenMode::Fullscreen:
+            if (cur_mode == FullscreenMode::None)
                 win->push_fullscreen_geom();
             win->set_geometry(full);
             break;
-        case eFullscreenMode::FSMODE_MAXIMIZED:
-            if (cur_mode == eFullscreenMode::FSMODE_NONE)
+        case FullscreenMode::Maximized:
+            if (cur_mode == FullscreenMode::None)
                 win->push_fullscreen_geom();
             win->set_geometry(max);
             break;
@@ -1140,17 +1234,19 @@ bool Row::is_overview() const
 
 void Row::toggle_overview()
 {
+    TraceScope scope(TraceCategory::Layout, "toggle_overview", workspace);
+    layout_stats.overview_toggle();
     if (columns.size() == 0)
         return;
     overview = !overview;
-    post_event("overview");
-    static auto *const *overview_scale_content = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:overview_scale_content")->getDataStaticPtr();
+    post_event(EventTopic::Overview);
+    const bool overview_scale_content = adapter->get_config().overview_scale_content;
     if (overview) {
         // Turn off fullscreen mode if enabled
         auto window = get_active_window();
-        preoverview_fsmode = window_fullscreen_state(window);
-        if (preoverview_fsmode != eFullscreenMode::FSMODE_NONE) {
-            toggle_window_fullscreen_internal(window, preoverview_fsmode);
+        preoverview_fsmode = window->get_fullscreen_mode();
+        if (preoverview_fsmode != FullscreenMode::None) {
+            window->toggle_fullscreen(preoverview_fsmode);
         }
         // Find the bounding box
         Vector2D bmin(max.x + max.w, max.y + max.h);
@@ -1173,7 +1269,7 @@ void Row::toggle_overview()
         double scale = std::min(max.w / w, max.h / h);
 
         bool overview_scaled;
-        if (**overview_scale_content && overviews->enable(workspace)) {
+        if (overview_scale_content && adapter->overview_enable(workspace)) {
             overview_scaled = true;
         } else {
             overview_scaled = false;
@@ -1188,13 +1284,10 @@ void Row::toggle_overview()
             }
             adjust_overview_columns();
 
-            PHLMONITOR monitor = window->m_pWorkspace->m_pMonitor.lock();
-            g_pHyprRenderer->damageMonitor(monitor);
-
-            overviews->set_scale(workspace, scale);
-            overviews->set_vecsize(workspace, monitor->vecSize);
+            adapter->damage_workspace(workspace);
+            adapter->overview_set_scale(workspace, scale);
             // Update cursor
-            get_active_window()->warpCursor();
+            get_active_window()->warp_cursor();
         } else {
             Vector2D offset(0.5 * (max.w - w * scale), 0.5 * (max.h - h * scale));
             for (auto c = columns.first(); c != nullptr; c = c->next()) {
@@ -1209,10 +1302,9 @@ void Row::toggle_overview()
             adjust_overview_columns();
         }
     } else {
-        if (**overview_scale_content && overviews->is_initialized()) {
-            PHLMONITOR monitor = get_active_window()->m_pWorkspace->m_pMonitor.lock();
-            overviews->disable(workspace);
-            g_pHyprRenderer->damageMonitor(monitor);
+        if (overview_scale_content) {
+            adapter->overview_disable(workspace);
+            adapter->damage_workspace(workspace);
         }
         for (auto c = columns.first(); c != nullptr; c = c->next()) {
             Column *col = c->data();
@@ -1229,18 +1321,19 @@ void Row::toggle_overview()
         adjust_columns(active);
         // Turn fullscreen mode back on if enabled
         auto window = get_active_window();
-        window->warpCursor();
-        if (preoverview_fsmode != eFullscreenMode::FSMODE_NONE) {
-            toggle_window_fullscreen_internal(window, preoverview_fsmode);
+        window->warp_cursor();
+        if (preoverview_fsmode != FullscreenMode::None) {
+            window->toggle_fullscreen(preoverview_fsmode);
         }
     }
 }
 
-void Row::update_windows(const Box &oldmax, bool force)
+void Row::update_windows(const Box &oldmax, bool force, bool animate)
 {
-    if (!force)
+    if (!force && !stale)
         return;
 
+    LayoutPlan plan;
     // Update active column position
     if (active && oldmax != max) {
         double posx = max.x + max.w * (active->data()->get_geom_x() - oldmax.x) / oldmax.w;
@@ -1256,11 +1349,31 @@ void Row::update_windows(const Box &oldmax, bool force)
         // Redo all windows for each column according to "height" (unless Free)
         column->update_heights();
     }
-    recalculate_row_geometry();
+    recalculate_row_geometry(animate);
 }
 
-void Row::recalculate_row_geometry()
+// Rows of workspaces that aren't visible don't move or resize their windows
+// until they are shown, when update_windows() lays them out against their
+// monitor in one pass
+bool Row::can_layout()
 {
+    if (loading)
+        return false;
+    if (!adapter->is_workspace_visible(workspace)) {
+        stale = true;
+        return false;
+    }
+    return true;
+}
+
+void Row::recalculate_row_geometry(bool animate)
+{
+    if (!can_layout())
+        return;
+    stale = false;
+    TraceScope scope(TraceCategory::Layout, "recalculate_row_geometry", workspace);
+    LayoutPlan plan;
+    layout_stats.relayout();
     if (active == nullptr)
         return;
 
@@ -1271,8 +1384,7 @@ void Row::recalculate_row_geometry()
         adjust_overview_columns();
         return;
     }
-    static auto* const *center_row = (Hyprlang::INT* const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:center_row_if_space_available")->getDataStaticPtr();
-    if (**center_row && pinned == nullptr) {
+    if (adapter->get_config().center_row_if_space_available && pinned == nullptr) {
         double lwidth = 0.0, rwidth = 0.0;
         for (auto col = columns.first(); col != active; col = col->next()) {
             lwidth += col->data()->get_geom_w();
@@ -1385,14 +1497,14 @@ void Row::recalculate_row_geometry()
             }
         }
         // Now, we know pinned is in the right position (it doesn't move)
-        adjust_columns(pinned);
+        adjust_columns(pinned, animate);
         return;
     }
 
-    if (modifier.get_center_column().value()) {
+    if (get_center_column()) {
         double start = max.x + 0.5 * (max.w - active->data()->get_geom_w());
         active->data()->set_geom_pos(start, max.y);
-        adjust_columns(active);
+        adjust_columns(active, animate);
         return;
     }
 
@@ -1484,12 +1596,13 @@ void Row::recalculate_row_geometry()
         }
     }
 
-    adjust_columns(active);
+    adjust_columns(active, animate);
 }
 
 // Adjust all the columns in the row using 'column' as anchor
-void Row::adjust_columns(ListNode<Column *> *column)
+void Row::adjust_columns(ListNode<Column *> *column, bool animate)
 {
+    TraceScope scope(TraceCategory::Layout, "adjust_columns", workspace);
     // Adjust the positions of the columns to the left
     for (auto col = column->prev(), prev = column; col != nullptr; prev = col, col = col->prev()) {
         col->data()->set_geom_pos(prev->data()->get_geom_x() - col->data()->get_geom_w(), max.y);
@@ -1504,7 +1617,7 @@ void Row::adjust_columns(ListNode<Column *> *column)
         // First and last columns need a different gap
         auto gap0 = col == columns.first() ? 0.0 : gap;
         auto gap1 = col == columns.last() ? 0.0 : gap;
-        col->data()->recalculate_col_geometry(Vector2D(gap0, gap1), gap, true);
+        col->data()->recalculate_col_geometry(Vector2D(gap0, gap1), gap, animate);
     }
 }
 
@@ -1523,7 +1636,7 @@ void Row::adjust_overview_columns()
 // Find the column where the mouse pointer is, or return active
 ListNode<Column *> *Row::get_mouse_column() const {
     // Find the column where the cursor is
-    auto pos = g_pInputManager->getMouseCoordsInternal();
+    auto pos = adapter->get_mouse_coords();
     auto column = active;
     for (auto col = columns.first(); col != nullptr; col = col->next()) {
         const auto x0 = col->data()->get_geom_x();
@@ -1536,15 +1649,22 @@ ListNode<Column *> *Row::get_mouse_column() const {
     return column;
 }
 void Row::scroll_update(Direction dir, const Vector2D &delta) {
+    // Only the old and new boxes of the windows that move need a redraw.
+    // Overview draws the whole monitor scaled, so it is damaged once.
+    if (overview)
+        adapter->damage_workspace(workspace);
     switch (dir) {
     case Direction::Up:
     case Direction::Down: {
         auto column = get_mouse_column();
+        damage_columns(column, column);
         column->data()->scroll_update(delta.y);
+        damage_columns(column, column);
         break;
     }
     case Direction::Left:
     case Direction::Right: {
+        damage_columns(columns.first(), columns.last());
         // Apply column geometry
         for (auto col = columns.first(); col != nullptr; col = col->next()) {
             col->data()->set_geom_pos(col->data()->get_geom_x() + delta.x, max.y);
@@ -1553,14 +1673,29 @@ void Row::scroll_update(Direction dir, const Vector2D &delta) {
             auto gap1 = col == columns.last() ? 0.0 : gap;
             col->data()->recalculate_col_geometry(Vector2D(gap0, gap1), gap, false);
         }
+        damage_columns(columns.first(), columns.last());
         break;
     }
     default:
         break;
     }
+}
 
-    auto monitor = g_pCompositor->getWorkspaceByID(workspace)->m_pMonitor;
-    g_pHyprRenderer->damageMonitor(monitor.lock());
+void Row::damage_columns(const ListNode<Column *> *from, const ListNode<Column *> *to)
+{
+    if (from == nullptr || overview)
+        return;
+    for (auto col = from; ; col = col->next()) {
+        const double x = col->data()->get_geom_x();
+        if (x < max.x + max.w && x + col->data()->get_geom_w() > max.x) {
+            damage_windows.clear();
+            col->data()->get_windows(damage_windows);
+            for (auto window : damage_windows)
+                window->damage();
+        }
+        if (col == to)
+            break;
+    }
 }
 
 void Row::scroll_end(Direction dir)
@@ -1594,5 +1729,120 @@ void Row::scroll_end(Direction dir)
         column->data()->scroll_end(dir, gap);
     }
     recalculate_row_geometry();
-    g_pCompositor->focusWindow(get_active_window());
+    get_active_window()->focus();
+}
+
+void Row::save(SnapshotRow &row) const
+{
+    row.workspace = workspace;
+    row.mode = mode;
+    row.active = -1;
+    row.pinned = -1;
+    row.columns.resize(columns.size());
+    int32_t index = 0;
+    for (auto col = columns.first(); col != nullptr; col = col->next(), ++index) {
+        if (col == active)
+            row.active = index;
+        if (col == pinned)
+            row.pinned = index;
+        col->data()->save(row.columns[index], overview);
+    }
+}
+
+void Row::restore(const SnapshotRow &saved, const std::unordered_map<WindowID, WindowID> &ids)
+{
+    TraceScope scope(TraceCategory::Layout, "restore", workspace);
+    bool overview_on = overview;
+    if (overview)
+        toggle_overview();
+
+    // Take the windows out of their columns, the adapters stay
+    std::vector<WindowAdapter *> windows;
+    get_windows(windows);
+    std::unordered_map<WindowID, WindowAdapter *> available;
+    for (auto window : windows)
+        available[window->get_id()] = window;
+    for (auto col = columns.first(); col != nullptr; col = col->next()) {
+        if (col == pinned)
+            col->data()->pin(false);
+        delete col->data();
+    }
+    columns.clear();
+    pinned = nullptr;
+    active = nullptr;
+
+    std::vector<std::pair<WindowAdapter *, const SnapshotWindow *>> column_windows;
+    double x = max.x;
+    for (int32_t c = 0; c < static_cast<int32_t>(saved.columns.size()); ++c) {
+        const SnapshotColumn &scolumn = saved.columns[c];
+        column_windows.clear();
+        for (const auto &swindow : scolumn.windows) {
+            auto id = ids.find(swindow.key.id);
+            if (id == ids.end())
+                continue;
+            auto window = available.find(id->second);
+            if (window == available.end() || window->second == nullptr)
+                continue;
+            column_windows.push_back({ window->second, &swindow });
+            window->second = nullptr;
+        }
+        if (column_windows.empty())
+            continue;
+        Column *column = new Column(this, scolumn, column_windows);
+        column->set_geom_pos(x, max.y);
+        x += column->get_geom_w();
+        auto node = columns.emplace_after(columns.last(), column);
+        if (active == nullptr || c == saved.active)
+            active = node;
+        if (c == saved.pinned) {
+            pinned = node;
+            column->pin(true);
+        }
+    }
+    // The rest go after the restored columns
+    auto restored_active = active;
+    for (auto window : windows) {
+        if (available[window->get_id()] == nullptr)
+            continue;
+        active = columns.emplace_after(columns.last(), new Column(window, this));
+    }
+    if (restored_active != nullptr)
+        active = restored_active;
+
+    set_mode(saved.mode);
+    reorder = Reorder::Auto;
+    recalculate_row_geometry();
+    if (overview_on)
+        toggle_overview();
+}
+
+std::string Row::check() const
+{
+    if (!columns.is_valid())
+        return std::format("workspace {}: broken column list", workspace);
+    if ((active == nullptr) != columns.empty() || (active != nullptr && !columns.contains(active)))
+        return std::format("workspace {}: active is not a column of the row", workspace);
+    if (pinned != nullptr && !columns.contains(pinned))
+        return std::format("workspace {}: pinned is not a column of the row", workspace);
+    int c = 0;
+    for (auto col = columns.first(); col != nullptr; col = col->next(), ++c) {
+        const std::string error = col->data()->check(this);
+        if (!error.empty())
+            return std::format("workspace {}, column {}: {}", workspace, c, error);
+    }
+    return "";
+}
+
+void Row::get_stats(StructureStats &stats) const
+{
+    stats.rows++;
+    stats.columns += columns.size();
+    stats.list_nodes += columns.size();
+    stats.bytes += sizeof(Row) + columns.size() * (sizeof(Column) + sizeof(ListNode<Column *>));
+    for (auto col = columns.first(); col != nullptr; col = col->next()) {
+        const size_t nwindows = col->data()->size();
+        stats.windows += nwindows;
+        stats.list_nodes += nwindows;
+        stats.bytes += nwindows * (sizeof(Window) + sizeof(ListNode<Window *>));
+    }
 }
@@ -1,44 +1,83 @@
 #ifndef SCROLLER_ROW_H
 #define SCROLLER_ROW_H
 
+#include <unordered_map>
+
 #include "column.h"
+#include "stats.h"
 
 class Row {
 public:
-    Row(WORKSPACEID workspace);
+    Row(WorkspaceID workspace, LayoutAdapter *adapter);
     ~Row();
     size_t size() const {
         return columns.size();
     }
-    WORKSPACEID get_workspace() const { return workspace; }
+    WorkspaceID get_workspace() const { return workspace; }
+    LayoutAdapter *get_adapter() const { return adapter; }
     const Box &get_max() const { return max; }
-    bool has_window(PHLWINDOW window) const {
+    // Center options of the mode modifier, or the configuration defaults
+    bool get_center_column() const {
+        return modifier.get_center_column().value_or(adapter->get_config().center_active_column);
+    }
+    bool get_center_window() const {
+        return modifier.get_center_window().value_or(adapter->get_config().center_active_window);
+    }
+    bool has_window(WindowID window) const {
         for (auto col = columns.first(); col != nullptr; col = col->next()) {
             if (col->data()->has_window(window))
                 return true;
         }
         return false;
     }
+    WindowAdapter *get_window(WindowID window) const {
+        for (auto col = columns.first(); col != nullptr; col = col->next()) {
+            Window *win = col->data()->get_window(window);
+            if (win != nullptr)
+                return win->get_window();
+        }
+        return nullptr;
+    }
     const Column *get_active_column() const {
         return active != nullptr? active->data() : nullptr;
     }
-    PHLWINDOW get_active_window() const {
+    WindowAdapter *get_active_window() const {
         return active != nullptr? active->data()->get_active_window() : nullptr;
     }
-    bool is_active(PHLWINDOW window) const {
-        return get_active_window() == window;
+    bool is_active(WindowID window) const {
+        auto awindow = get_active_window();
+        return awindow != nullptr && awindow->get_id() == window;
     }
-    void get_windows(std::vector<PHLWINDOWREF> &windows) {
+    void get_windows(std::vector<WindowAdapter *> &windows) {
         for (auto col = columns.first(); col != nullptr; col = col->next()) {
             col->data()->get_windows(windows);
         }
     }
-    void add_active_window(PHLWINDOW window);
+    void add_active_window(WindowAdapter *window);
+    // Adds a window detached from another row, with its sizes and state
+    void attach_window(Window *window);
+    // Bulk load: windows added or removed after begin_load() are only placed
+    // in or taken out of their columns, without any geometry or fullscreen
+    // changes. end_load() keeps a fullscreen window active if there is one,
+    // and lays out the row once, by default without animations.
+    void begin_load() { loading = true; }
+    void end_load(bool animate = false);
+    bool is_loading() const { return loading; }
     // Remove a window and re-adapt rows and columns, returning
     // true if successful, or false if this is the last row
     // so the layout can remove it.
-    bool remove_window(PHLWINDOW window);
-    void focus_window(PHLWINDOW window); 
+    bool remove_window(WindowID window);
+    // Takes window out of the row without deleting it, for a move to another
+    // row. The row can be left empty; the caller deletes it then.
+    Window *detach_window(WindowID window);
+    // The row changed while its workspace wasn't visible, so it wasn't laid
+    // out. The next update_windows() lays it out, once it is shown.
+    bool is_stale() const { return stale; }
+    // Focus changes from the compositor. If scroll is false, or laying out
+    // the row would leave the column where it is, only the columns whose
+    // active state changed are laid out. Returns true if the row was laid
+    // out.
+    bool focus_window(WindowID window, bool scroll = true);
     bool move_focus(Direction dir, bool focus_wrap);
 
     void resize_active_column(int step);
@@ -47,13 +86,13 @@ public:
     void set_mode(Mode m, bool silent = false);
     Mode get_mode() const;
     void set_mode_modifier(const ModeModifier &m);
-    ModeModifier get_mode_modifier() const;
+    const ModeModifier &get_mode_modifier() const;
     void find_auto_insert_point(Mode &new_mode, ListNode<Column *> *&new_active);
     void align_column(Direction dir);
     void pin();
     Column *get_pinned_column() const;
     void selection_toggle();
-    void selection_set(PHLWINDOWREF window);
+    void selection_set(WindowID window);
     void selection_all();
     void selection_reset();
     void selection_move(const List<Column *> &columns, Direction direction);
@@ -65,21 +104,41 @@ public:
     void admit_window(AdmitExpelDirection dir);
     void expel_window(AdmitExpelDirection dir);
     Vector2D predict_window_size() const;
-    void post_event(const std::string &event);
+    void post_event(EventTopic topic);
     // Returns the old viewport
-    bool update_sizes(PHLMONITOR monitor);
-    void set_fullscreen_mode_windows(eFullscreenMode mode);
-    void set_fullscreen_mode(PHLWINDOW window, eFullscreenMode cur_mode, eFullscreenMode new_mode);
+    bool update_sizes(MonitorID monitor);
+    void set_fullscreen_mode_windows(FullscreenMode mode);
+    void set_fullscreen_mode(WindowID window, FullscreenMode cur_mode, FullscreenMode new_mode);
     void fit_size(FitSize fitsize);
     bool is_overview() const;
     void toggle_overview();
-    void update_windows(const Box &oldmax, bool force);
-    void recalculate_row_geometry();
+    void update_windows(const Box &oldmax, bool force, bool animate = true);
+    void recalculate_row_geometry(bool animate = true);
 
     void scroll_update(Direction dir, const Vector2D &delta);
     void scroll_end(Direction dir);
 
+    // Snapshots (see snapshot.h). restore() rebuilds the row with the
+    // windows it has: the ones ids maps the snapshot's windows to, in the
+    // columns, order and sizes of saved, followed by the rest in their
+    // current order, one per column.
+    void save(SnapshotRow &row) const;
+    void restore(const SnapshotRow &saved, const std::unordered_map<WindowID, WindowID> &ids);
+
+    // Objects and memory held by the row, added to stats
+    void get_stats(StructureStats &stats) const;
+    // Structural checks for the headless tools: empty if consistent
+    std::string check() const;
+
 private:
+    // Adds window, or moved if not nullptr
+    void insert_window(WindowAdapter *window, Window *moved);
+    // false while loading or hidden, see recalculate_row_geometry()
+    bool can_layout();
+    bool is_in_viewport(const ListNode<Column *> *column) const;
+    // Whether recalculate_row_geometry() would leave column, made active,
+    // where it is
+    bool keeps_position(const ListNode<Column *> *column) const;
     bool move_focus_left(bool focus_wrap); 
     bool move_focus_right(bool focus_wrap);
     void move_focus_begin();
@@ -88,17 +147,23 @@ private:
     // Calculate lateral gaps for a column
     Vector2D calculate_gap_x(const ListNode<Column *> *column) const;
     // Adjust all the columns in the row using 'column' as anchor
-    void adjust_columns(ListNode<Column *> *column);
+    void adjust_columns(ListNode<Column *> *column, bool animate = true);
     // Adjust all the columns in the overview
     void adjust_overview_columns();
     void size_active_column(StandardSize size);
     ListNode<Column *> *get_mouse_column() const;
+    // Damages the windows of the columns from..to that meet the viewport,
+    // nothing in overview
+    void damage_columns(const ListNode<Column *> *from, const ListNode<Column *> *to);
 
-    WORKSPACEID workspace;
+    WorkspaceID workspace;
+    LayoutAdapter *adapter;
     Box full;
     Box max;
     bool overview;
-    eFullscreenMode preoverview_fsmode;
+    bool loading;
+    bool stale;
+    FullscreenMode preoverview_fsmode;
     int gap;
     Reorder reorder;
     Mode mode;
@@ -106,6 +171,8 @@ private:
     ListNode<Column *> *pinned;
     ListNode<Column *> *active;
     List<Column *> columns;
+    // Reused by damage_columns(), so swipes don't allocate
+    std::vector<WindowAdapter *> damage_windows;
 };
 
 #endif // SCROLLER_ROW_H
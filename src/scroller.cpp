@@ -8,6 +8,7 @@
 #include <hyprland/src/managers/EventManager.hpp>
 #include <hyprland/src/plugins/PluginAPI.hpp>
 #include <hyprland/src/render/Renderer.hpp>
+#include <hyprland/src/render/OpenGL.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
 
 #include "scroller.h"
@@ -15,10 +16,17 @@
 #include "functions.h"
 #include "row.h"
 #include "column.h"
+#include "decorations.h"
+#include "hyprland.h"
+#include "marks.h"
 #include "overview.h"
+#include "record.h"
+#include "stats.h"
 
+#include <algorithm>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 
@@ -29,255 +37,88 @@ extern Overview *overviews;
 std::function<SDispatchResult(std::string)> orig_moveFocusTo;
 std::function<SDispatchResult(std::string)> orig_moveActiveTo;
 
-class Marks {
-public:
-    Marks() {}
-    ~Marks() { reset(); }
-    void reset() {
-        marks.clear();
-        post_mark_event(nullptr);
-    }
-    // Add a mark with name for window, overwriting any existing one with that name
-    void add(PHLWINDOW window, const std::string &name) {
-        const auto mark = marks.find(name);
-        if (mark != marks.end()) {
-            mark->second = window;
-            post_mark_event(window);
-            return;
-        }
-        marks[name] = window;
-        post_mark_event(window);
-    }
-    void del(const std::string &name) {
-        const auto mark = marks.find(name);
-        if (mark != marks.end()) {
-            if (g_pCompositor->m_pLastWindow == mark->second)
-                post_mark_event(nullptr);
-            marks.erase(mark);
-        }
-    }
-    // Remove window from list of marks (used when a window gets deleted)
-    void remove(PHLWINDOW window) {
-        for(auto it = marks.begin(); it != marks.end();) {
-            if (it->second.lock() == window)
-                it = marks.erase(it);
-            else
-                it++;
-        }
-    }
-    // If the mark exists, returns that window, otherwise it returns null
-    PHLWINDOW visit(const std::string &name) {
-        const auto mark = marks.find(name);
-        if (mark != marks.end()) {
-            return mark->second.lock();
-        }
-        return nullptr;
-    }
+static Marks *marks;
+static Trails *trails;
 
-    void post_mark_event(PHLWINDOW window) {
-        bool marked = false;
-        for(auto it = marks.begin(); it != marks.end(); it++) {
-            if (it->second.lock() == window) {
-                g_pEventManager->postEvent(SHyprIPCEvent{"scroller", std::format("mark, 1, {}", it->first)});
-                return;
-            }
-        }
-        g_pEventManager->postEvent(SHyprIPCEvent{"scroller", "mark, 0, "});
-    }
+static SP<HOOK_CALLBACK_FN> workspaceHookCallback;
+static SP<HOOK_CALLBACK_FN> focusedMonHookCallback;
+static SP<HOOK_CALLBACK_FN> activeWindowHookCallback;
+static SP<HOOK_CALLBACK_FN> swipeBeginHookCallback;
+static SP<HOOK_CALLBACK_FN> swipeUpdateHookCallback;
+static SP<HOOK_CALLBACK_FN> swipeEndHookCallback;
+static SP<HOOK_CALLBACK_FN> mouseMoveHookCallback;
+static SP<HOOK_CALLBACK_FN> configReloadedHookCallback;
 
-private:
-    std::unordered_map<std::string, PHLWINDOWREF> marks;
-};
+// Hyprland moves a tiled window to another workspace removing it from the
+// layout and adding it back, all inside moveWindowToWorkspaceSafe(). The
+// hook tells onWindowRemovedTiling() which window is moving.
+static CFunctionHook *g_pMoveWindowToWorkspaceSafeHook = nullptr;
+typedef void (*origMoveWindowToWorkspaceSafe)(void *thisptr, PHLWINDOW window, PHLWORKSPACE workspace);
+static PHLWINDOW moving_window;
 
-static Marks marks;
+static void hookMoveWindowToWorkspaceSafe(void *thisptr, PHLWINDOW window, PHLWORKSPACE workspace) {
+    moving_window = window;
+    ((origMoveWindowToWorkspaceSafe)(g_pMoveWindowToWorkspaceSafeHook->m_pOriginal))(thisptr, window, workspace);
+    moving_window = nullptr;
+}
 
-class Trail {
-protected:
-    Trail(int number) : number(number), active(nullptr) {}
-    ~Trail() {}
+// Layout snapshots, see snapshot.h
+static bool snapshot_enabled() {
+    static auto *const *SNAPSHOT = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:snapshot")->getDataStaticPtr();
+    return **SNAPSHOT != 0;
+}
 
-    void toggle(const PHLWINDOW window) {
-        auto win = marks.first();
-        while (win != nullptr) {
-            auto next = win->next();
-            if (win->data() == window) {
-                active = active != marks.last() ? active->next() : active->prev();
-                marks.erase(win);
-                return;
-            }
-            win = next;
-        }
-        if (active == nullptr) {
-            marks.push_back(window);
-            active = marks.first();
-        } else {
-            marks.insert_after(active, window);
-            active = active->next();
-        }
-    }
-    void remove_window(PHLWINDOW window) {
-        auto win = marks.first();
-        while (win != nullptr) {
-            auto next = win->next();
-            if (win->data() == window) {
-                active = active != marks.last() ? active->next() : active->prev();
-                marks.erase(win);
-                return;
-            }
-            win = next;
-        }
-    }
-    void next() {
-        if (active == nullptr)
-            return;
-        active = active == marks.last() ? marks.first() : active->next();
-    }
-    void prev() {
-        if (active == nullptr)
-            return;
-        active = active == marks.first() ? marks.last() : active->prev();
-    }
-    void clear() {
-        marks.clear();
-        active = nullptr;
-    }
-    bool is_marked(PHLWINDOW window) const {
-        for (auto win = marks.first(); win != nullptr; win = win->next()) {
-            if (win->data() == window)
-                return true;
-        }
-        return false;
-    }
-    void toselection() const {
-        for (auto win = marks.first(); win != nullptr; win = win->next()) {
-            g_ScrollerLayout->selection_set(win->data());
-        }
-        // Re-render windows to show decorations
-        for (auto monitor : g_pCompositor->m_vMonitors) {
-            g_pHyprRenderer->damageMonitor(monitor);
-        }
+// $XDG_STATE_HOME/hyprscroller/snapshot, empty if there is no state directory
+static const std::string &snapshot_path() {
+    static std::string path;
+    if (path.empty()) {
+        const char *state_home = getenv("XDG_STATE_HOME");
+        const char *home = getenv("HOME");
+        if (state_home != nullptr && state_home[0] == '/')
+            path = std::string(state_home) + "/hyprscroller/snapshot";
+        else if (home != nullptr && home[0] == '/')
+            path = std::string(home) + "/.local/state/hyprscroller/snapshot";
     }
+    return path;
+}
 
-private:
-    friend class Trails;
-
-    int number;
-    ListNode<const PHLWINDOWREF> *active;
-    List<const PHLWINDOWREF> marks;
-};
+static WindowKey window_key(WindowAdapter *window) {
+    const auto w = hyprland_window(window);
+    if (w == nullptr)
+        return { window->get_id(), {}, {} };
+    return { window->get_id(), w->m_szClass, w->m_szTitle };
+}
 
-class Trails {
-public:
-    Trails() : counter(0), active(nullptr) {
-        //trail_new();
-    }
-    ~Trails() {
-        for (auto trail = trails.first(); trail != nullptr; trail = trail->next()) {
-            delete trail->data();
-        }
-        active = nullptr;
-        post_trailmark_event(nullptr);
-        post_trail_event();
-    }
-    void remove_window(PHLWINDOW window) {
-        for (auto trail = trails.first(); trail != nullptr; trail = trail->next()) {
-            trail->data()->remove_window(window);
-        }
-        post_trail_event();
-    }
+static int snapshot_timer_fired(void *data) {
+    static_cast<ScrollerLayout *>(data)->snapshot_write();
+    return 0;
+}
 
-    size_t get_active_size() const {
-        return active ? active->data()->marks.size() : 0;
-    }
-    int get_active_number() const {
-        return active ? active->data()->number : -1;
-    }
-    bool get_active_marked(PHLWINDOW window) const {
-        return active ? active->data()->is_marked(window) : false;
-    }
-    PHLWINDOW get_active() const {
-        if (active == nullptr) {
-            return nullptr;
-        } else {
-            auto mark = active->data();
-            if (mark->active != nullptr) {
-                return mark->active->data().lock();
-            } else {
-                return nullptr;
-            }
-        }
-    }
-    void trail_new() {
-        trails.push_back(new Trail(counter++));
-        active = trails.last();
-        post_trail_event();
-    }
-    void trail_next() {
-        active = active == trails.last() ? trails.first() : active->next();
-        post_trail_event();
-    }
-    void trail_prev() {
-        active = active == trails.first() ? trails.last() : active->prev();
-        post_trail_event();
-    }
-    void trail_delete() {
-        if (active == nullptr)
-            return;
-        auto act = active == trails.first() ? active->next() : active->prev();
-        trails.erase(active);
-        delete active->data();
-        active = act;
-        post_trail_event();
-    }
-    void trail_clear() {
-        if (active == nullptr)
-            return;
-        active->data()->clear();
-        post_trail_event();
-    }
+static int record_timer_fired(void *data) {
+    static_cast<ScrollerLayout *>(data)->record_flush();
+    return 0;
+}
 
-    void trail_toselection() {
-        if (active == nullptr)
-            return;
-        active->data()->toselection();
-    }
+static int idle_fired(void *data) {
+    static_cast<ScrollerLayout *>(data)->idle_fired();
+    return 0;
+}
 
-    void trailmark_toggle(PHLWINDOW window) {
-        if (active == nullptr) {
-            trail_new();
-        }
-        active->data()->toggle(window);
-        post_trailmark_event(window);
-        post_trail_event();
-    }
-    void trailmark_next() {
-        if (active == nullptr)
-            return;
-        active->data()->next();
-    }
-    void trailmark_prev() {
-        if (active == nullptr)
-            return;
-        active->data()->prev();
-    }
+static int motion_idle_fired(void *data) {
+    static_cast<ScrollerLayout *>(data)->motion_idle_fired();
+    return 0;
+}
 
-    void post_trail_event() {
-        g_pEventManager->postEvent(SHyprIPCEvent{"scroller", std::format("trail, {}, {}", get_active_number(), get_active_size())});
-    }
-    void post_trailmark_event(PHLWINDOW window) {
-        bool marked = false;
-        if (active != nullptr && active->data()->is_marked(window))
-            marked = true;
-        g_pEventManager->postEvent(SHyprIPCEvent{"scroller", std::format("trailmark, {}", marked ? 1 : 0)});
-    }
+static int hover_timer_fired(void *data) {
+    static_cast<ScrollerLayout *>(data)->hover_timer_fired();
+    return 0;
+}
 
-private:
-    int counter;
-    ListNode<Trail *> *active;
-    List<Trail *> trails;
-};
+static bool defer_layout_enabled() {
+    static auto *const *DEFER = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:defer_layout")->getDataStaticPtr();
+    return **DEFER != 0;
+}
 
-static Trails *trails;
 
 // ScrollerLayout
 Row *ScrollerLayout::getRowForWorkspace(WORKSPACEID workspace) {
@@ -288,9 +129,21 @@ Row *ScrollerLayout::getRowForWorkspace(WORKSPACEID workspace) {
     return nullptr;
 }
 
+PHLWINDOW ScrollerLayout::getWindow(WindowID window) {
+    if (window == 0)
+        return nullptr;
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        WindowAdapter *w = row->data()->get_window(window);
+        if (w != nullptr)
+            return hyprland_window(w);
+    }
+    return nullptr;
+}
+
 Row *ScrollerLayout::getRowForWindow(PHLWINDOW window) {
+    const WindowID id = window_id(window);
     for (auto row = rows.first(); row != nullptr; row = row->next()) {
-        if (row->data()->has_window(window))
+        if (row->data()->has_window(id))
             return row->data();
     }
     return nullptr;
@@ -302,19 +155,37 @@ Row *ScrollerLayout::getRowForWindow(PHLWINDOW window) {
     If !animationinprogress, then the anim mgr will not apply an anim.
 */
 void ScrollerLayout::onWindowCreatedTiling(PHLWINDOW window, eDirection)
+{
+    StatsScope stats(StatsTrigger::Window);
+    addWindow(window);
+    if (!restoring.empty())
+        restoreSnapshot(window_id(window));
+    snapshot_changed(false);
+}
+
+void ScrollerLayout::addWindow(PHLWINDOW window)
 {
     WORKSPACEID wid = window->workspaceID();
+
+    // Undo possible modifications from general options.
+    window->unsetWindowData(PRIORITY_LAYOUT);
+    window->updateWindowData();
+
+    if (attachWindow(window))
+        return;
+
     auto s = getRowForWorkspace(wid);
     if (s == nullptr) {
-        s = new Row(wid);
+        s = new Row(wid, &adapter);
         rows.push_back(s);
     }
+    deferLayout(s);
 
-    // Undo possible modifications from general options.
-    window->unsetWindowData(PRIORITY_LAYOUT);
-    window->updateWindowData();
+    auto hwindow = new HyprlandWindow(window);
+    if (recorder.is_recording())
+        recorder.window_open(wid, hwindow, hwindow->get_all_rules());
 
-    s->add_active_window(window);
+    s->add_active_window(hwindow);
 
     // Check window rules
     for (auto &r: window->m_vMatchedRules) {
@@ -338,7 +209,7 @@ void ScrollerLayout::onWindowCreatedTiling(PHLWINDOW window, eDirection)
             }
         } else if (r->szRule.starts_with("plugin:scroller:marksadd")) {
             const auto mark_name = r->szRule.substr(r->szRule.find_first_of(' ') + 1);
-            marks.add(window, mark_name);
+            marks->add(window_id(window), mark_name);
         }
     }
 }
@@ -356,23 +227,20 @@ void ScrollerLayout::onWindowCreatedTiling(PHLWINDOW window, eDirection)
 */
 void ScrollerLayout::onWindowRemovedTiling(PHLWINDOW window)
 {
+    StatsScope stats(StatsTrigger::Window);
     auto s = getRowForWindow(window);
     if (s == nullptr)
         return;
 
-    marks.remove(window);
-    trails->remove_window(window);
-
-    if (!s->remove_window(window)) {
-        // It was the last one, remove the row
-        for (auto row = rows.first(); row != nullptr; row = row->next()) {
-            if (row->data() == s) {
-                rows.erase(row);
-                delete row->data();
-                break;
-            }
-        }
+    // Moving to another workspace, it is added back right away
+    if (window == moving_window && !window->m_bIsFloating) {
+        detachWindow(s, window_id(window));
+        snapshot_changed(false);
+        return;
     }
+
+    removeWindow(s, window_id(window));
+    snapshot_changed(false);
     if (window->m_bIsFloating)
         return;
 
@@ -386,7 +254,122 @@ void ScrollerLayout::onWindowRemovedTiling(PHLWINDOW window)
     }
     s = getRowForWorkspace(workspace_id);
     if (s != nullptr)
-        force_focus_to_window(s->get_active_window());
+        force_focus_to_window(hyprland_window(s->get_active_window()));
+}
+
+bool ScrollerLayout::removeWindow(Row *s, WindowID window)
+{
+    recorder.op("close", window);
+    marks->remove(window);
+    trails->remove_window(window);
+
+    // The layout doesn't own the adapter, delete it once the window is out
+    WindowAdapter *window_adapter = s->get_window(window);
+    const bool last = !s->remove_window(window);
+    delete window_adapter;
+    if (last) {
+        // It was the last one, remove the row
+        deleteRow(s);
+        return false;
+    }
+    return true;
+}
+
+void ScrollerLayout::deleteRow(Row *s)
+{
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        if (row->data() == s) {
+            delete row->data();
+            rows.erase(row);
+            return;
+        }
+    }
+}
+
+void ScrollerLayout::detachWindow(Row *s, WindowID window)
+{
+    deferLayout(s);
+    recorder.op("detach", window);
+    detached.push_back(s->detach_window(window));
+    if (s->size() == 0)
+        deleteRow(s);
+    scheduleIdle();
+}
+
+bool ScrollerLayout::attachWindow(PHLWINDOW window)
+{
+    const auto d = std::find_if(detached.begin(), detached.end(), [&window](const Window *w) {
+        return w->get_id() == window_id(window);
+    });
+    if (d == detached.end())
+        return false;
+
+    const WORKSPACEID wid = window->workspaceID();
+    auto s = getRowForWorkspace(wid);
+    if (s == nullptr) {
+        s = new Row(wid, &adapter);
+        rows.push_back(s);
+    }
+    deferLayout(s);
+    recorder.op("attach", window_id(window), wid);
+    s->attach_window(*d);
+    detached.erase(d);
+    return true;
+}
+
+void ScrollerLayout::idle_fired()
+{
+    // The event loop removes idle sources after calling them
+    idle = nullptr;
+    StatsScope stats(StatsTrigger::Deferred);
+    closeDetached();
+    flushDeferred();
+}
+
+void ScrollerLayout::scheduleIdle()
+{
+    if (idle == nullptr)
+        idle = wl_event_loop_add_idle(g_pCompositor->m_sWLEventLoop, ::idle_fired, this);
+}
+
+// Rows in overview or already loading are laid out right away as usual
+void ScrollerLayout::deferLayout(Row *s)
+{
+    if (!defer_layout_enabled() || s->is_loading() || s->is_overview())
+        return;
+    recorder.op("deferlayout", s->get_workspace());
+    s->begin_load();
+    deferred.push_back(s->get_workspace());
+    scheduleIdle();
+}
+
+void ScrollerLayout::flushDeferred()
+{
+    for (auto workspace : deferred) {
+        // Rows can be gone if all their windows closed
+        auto s = getRowForWorkspace(workspace);
+        if (s != nullptr && s->is_loading()) {
+            recorder.op("flushlayout", workspace);
+            s->end_load(true);
+        }
+    }
+    deferred.clear();
+}
+
+// Hyprland already focused what it wanted when it moved the window
+void ScrollerLayout::closeDetached()
+{
+    for (auto window : detached) {
+        const WindowID id = window->get_id();
+        recorder.op("close", id);
+        marks->remove(id);
+        trails->remove_window(id);
+        // The layout doesn't own the adapter
+        WindowAdapter *window_adapter = window->get_window();
+        delete window;
+        delete window_adapter;
+    }
+    detached.clear();
 }
 
 /*
@@ -400,7 +383,7 @@ void ScrollerLayout::onWindowRemovedFloating(PHLWINDOW)
     }
     auto s = getRowForWorkspace(workspace_id);
     if (s != nullptr)
-        g_pCompositor->focusWindow(s->get_active_window());
+        g_pCompositor->focusWindow(hyprland_window(s->get_active_window()));
 }
 
 /*
@@ -408,6 +391,7 @@ void ScrollerLayout::onWindowRemovedFloating(PHLWINDOW)
 */
 void ScrollerLayout::onWindowFocusChange(PHLWINDOW window)
 {
+    StatsScope stats(StatsTrigger::FocusChange);
     if (window == nullptr) { // no window has focus
         return;
     }
@@ -416,7 +400,31 @@ void ScrollerLayout::onWindowFocusChange(PHLWINDOW window)
     if (s == nullptr) {
         return;
     }
-    s->focus_window(window);
+    // Windows focused by moving the pointer scroll the row at most once
+    // every focus_hover_ms, so moving the mouse across the gap between two
+    // columns that don't fit together doesn't scroll back and forth. A
+    // window that still has focus when that time is over scrolls then.
+    static auto *const *HOVER = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:focus_hover_ms")->getDataStaticPtr();
+    const auto now = std::chrono::steady_clock::now();
+    hover_window = 0;
+    if (**HOVER > 0 && pointer_motion) {
+        const auto wait = std::chrono::milliseconds(**HOVER) - (now - hover_scroll);
+        const bool scroll = wait <= std::chrono::milliseconds(0);
+        recorder.op("focus", window_id(window), scroll);
+        if (s->focus_window(window_id(window), scroll))
+            hover_scroll = now;
+        if (!scroll) {
+            hover_window = window_id(window);
+            if (hover_timer == nullptr)
+                hover_timer = wl_event_loop_add_timer(g_pCompositor->m_sWLEventLoop, ::hover_timer_fired, this);
+            wl_event_source_timer_update(hover_timer,
+                std::max(1, (int)std::chrono::ceil<std::chrono::milliseconds>(wait).count()));
+        }
+    } else {
+        recorder.op("focus", window_id(window));
+        s->focus_window(window_id(window));
+    }
+    snapshot_changed(false);
 }
 
 /*
@@ -433,23 +441,28 @@ bool ScrollerLayout::isWindowTiled(PHLWINDOW window)
 */
 void ScrollerLayout::recalculateMonitor(const MONITORID &monitor_id)
 {
+    StatsScope stats(StatsTrigger::RecalculateMonitor);
     const auto PMONITOR = g_pCompositor->getMonitorFromID(monitor_id);
     if (!PMONITOR)
         return;
 
     g_pHyprRenderer->damageMonitor(PMONITOR);
 
+    // The special and regular workspaces commit their windows together
+    LayoutPlan plan;
     WORKSPACEID specialID = PMONITOR->activeSpecialWorkspaceID();
     if (specialID) {
         auto sw = getRowForWorkspace(specialID);
         if (sw == nullptr) {
             return;
         }
-        const Box oldmax = sw->get_max();
-        const bool force = sw->update_sizes(PMONITOR);
         auto PWORKSPACESPECIAL = PMONITOR->activeSpecialWorkspace;
+        recorder.op("recalculatemonitor", PMONITOR->ID, specialID, PWORKSPACESPECIAL->m_bHasFullscreenWindow,
+                    to_fullscreen_mode(PWORKSPACESPECIAL->m_efFullscreenMode));
+        const Box oldmax = sw->get_max();
+        const bool force = sw->update_sizes(PMONITOR->ID);
         if (PWORKSPACESPECIAL->m_bHasFullscreenWindow) {
-            sw->set_fullscreen_mode_windows(PWORKSPACESPECIAL->m_efFullscreenMode);
+            sw->set_fullscreen_mode_windows(to_fullscreen_mode(PWORKSPACESPECIAL->m_efFullscreenMode));
         } else {
             sw->update_windows(oldmax, force);
         }
@@ -463,21 +476,119 @@ void ScrollerLayout::recalculateMonitor(const MONITORID &monitor_id)
     if (s == nullptr)
         return;
 
+    recorder.op("recalculatemonitor", PMONITOR->ID, PWORKSPACE->m_iID, PWORKSPACE->m_bHasFullscreenWindow,
+                to_fullscreen_mode(PWORKSPACE->m_efFullscreenMode));
     const Box oldmax = s->get_max();
-    const bool force = s->update_sizes(PMONITOR);
+    const bool force = s->update_sizes(PMONITOR->ID);
     if (PWORKSPACE->m_bHasFullscreenWindow) {
-        s->set_fullscreen_mode_windows(PWORKSPACE->m_efFullscreenMode);
+        s->set_fullscreen_mode_windows(to_fullscreen_mode(PWORKSPACE->m_efFullscreenMode));
     } else {
         s->update_windows(oldmax, force);
     }
 }
 
+// Touchpad and pointer callbacks run on every input event, so they are only
+// registered while an option needs them
+void ScrollerLayout::updateInputCallbacks()
+{
+    static auto *const *HS = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "gestures:workspace_swipe")->getDataStaticPtr();
+    static auto *const *SENABLE = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:gesture_scroll_enable")->getDataStaticPtr();
+    static auto *const *OENABLE = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:gesture_overview_enable")->getDataStaticPtr();
+    static auto *const *WENABLE = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:gesture_workspace_switch_enable")->getDataStaticPtr();
+    static auto *const *TIMEOUT = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:focus_edge_ms")->getDataStaticPtr();
+    static auto *const *HOVER = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:focus_hover_ms")->getDataStaticPtr();
+
+    // Hyprland's workspace_swipe has to be blocked even if none of our
+    // gestures is enabled
+    const bool gestures = **SENABLE || **OENABLE || **WENABLE || **HS;
+    if (gestures && swipeBeginHookCallback == nullptr) {
+        swipeBeginHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "swipeBegin", [&](void* /* self */, SCallbackInfo& /* info */, std::any param) {
+            auto swipe_event = std::any_cast<IPointer::SSwipeBeginEvent>(param);
+            swipe_begin(swipe_event);
+        });
+        swipeUpdateHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "swipeUpdate", [&](void* /* self */, SCallbackInfo& info, std::any param) {
+            auto swipe_event = std::any_cast<IPointer::SSwipeUpdateEvent>(param);
+            swipe_update(info, swipe_event);
+        });
+        swipeEndHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "swipeEnd", [&](void* /* self */, SCallbackInfo& info, std::any param) {
+            auto swipe_event = std::any_cast<IPointer::SSwipeEndEvent>(param);
+            swipe_end(info, swipe_event);
+        });
+    } else if (!gestures && swipeBeginHookCallback != nullptr) {
+        swipeBeginHookCallback.reset();
+        swipeUpdateHookCallback.reset();
+        swipeEndHookCallback.reset();
+        // A swipe in progress won't end here
+        swipe_active = false;
+        gesture_delta = Vector2D(0.0, 0.0);
+        swipe_direction = Direction::Begin;
+    }
+
+    const bool motion = **TIMEOUT > 0 || **HOVER > 0;
+    if (motion && mouseMoveHookCallback == nullptr) {
+        mouseMoveHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "mouseMove", [&](void* /* self */, SCallbackInfo& info, std::any param) {
+            Vector2D mousePos = std::any_cast<Vector2D>(param);
+            mouse_move(info, mousePos);
+        });
+    } else if (!motion && mouseMoveHookCallback != nullptr) {
+        mouseMoveHookCallback.reset();
+        pointer_motion = false;
+    }
+}
+
+void ScrollerLayout::prepareJumpLabels()
+{
+    static auto FALLBACKFONT = CConfigValue<std::string>("misc:font_family");
+    static auto const *FONT = (Hyprlang::STRING const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:jump_labels_font")->getDataStaticPtr();
+    static auto *const *COLOR = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:jump_labels_color")->getDataStaticPtr();
+    static auto const *KEYS = (Hyprlang::STRING const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:jump_labels_keys")->getDataStaticPtr();
+    std::string font(*FONT);
+    if (font == "")
+        font = *FALLBACKFONT;
+    jump_labels.prepare(*KEYS, font, static_cast<uint32_t>(**COLOR));
+}
+
+void ScrollerLayout::onConfigReloaded()
+{
+    // Options changes affect every row; gap changes only the rows whose
+    // viewport changed. Hidden rows only update their sizes, and are laid
+    // out when their workspace is shown. Windows commit once, after every
+    // row is planned.
+    StatsScope stats(StatsTrigger::Config);
+    const bool changed = adapter.compile_config();
+    updateInputCallbacks();
+    prepareJumpLabels();
+    LayoutPlan plan;
+    for (auto &monitor : g_pCompositor->m_vMonitors) {
+        bool damage = false;
+        for (auto row = rows.first(); row != nullptr; row = row->next()) {
+            Row *s = row->data();
+            const auto workspace = g_pCompositor->getWorkspaceByID(s->get_workspace());
+            if (workspace == nullptr || workspace->m_pMonitor.lock() != monitor)
+                continue;
+            recorder.op("reloadconfig", monitor->ID, s->get_workspace(), changed, workspace->m_bHasFullscreenWindow,
+                        to_fullscreen_mode(workspace->m_efFullscreenMode));
+            const Box oldmax = s->get_max();
+            if (!s->update_sizes(monitor->ID) && !changed)
+                continue;
+            if (workspace->m_bHasFullscreenWindow)
+                s->set_fullscreen_mode_windows(to_fullscreen_mode(workspace->m_efFullscreenMode));
+            else
+                s->update_windows(oldmax, true, false);
+            damage = true;
+        }
+        if (damage)
+            g_pHyprRenderer->damageMonitor(monitor);
+    }
+}
+
 /*
     Called when the compositor requests a window
     to be recalculated, e.g. when pseudo is toggled.
 */
 void ScrollerLayout::recalculateWindow(PHLWINDOW window)
 {
+    StatsScope stats(StatsTrigger::RecalculateWindow);
     // It can get called after windows are already being destroyed (decorations update)
     if (!enabled)
         return;
@@ -486,6 +597,7 @@ void ScrollerLayout::recalculateWindow(PHLWINDOW window)
     if (s == nullptr)
         return;
 
+    recorder.op("recalculatewindow", window_id(window));
     s->recalculate_row_geometry();
 }
 
@@ -497,6 +609,7 @@ void ScrollerLayout::recalculateWindow(PHLWINDOW window)
 void ScrollerLayout::resizeActiveWindow(const Vector2D &delta,
                                         eRectCorner /* corner */, PHLWINDOW window)
 {
+    StatsScope stats(StatsTrigger::Window);
     const auto PWINDOW = window ? window : g_pCompositor->m_pLastWindow.lock();
     auto s = getRowForWindow(PWINDOW);
     if (s == nullptr) {
@@ -507,7 +620,9 @@ void ScrollerLayout::resizeActiveWindow(const Vector2D &delta,
         return;
     }
 
+    recorder.op("resizewindow", window_id(PWINDOW), delta);
     s->resize_active_window(delta);
+    snapshot_changed(true);
 }
 
 /*
@@ -519,6 +634,7 @@ void ScrollerLayout::fullscreenRequestForWindow(PHLWINDOW window,
                                                 const eFullscreenMode CURRENT_EFFECTIVE_MODE,
                                                 const eFullscreenMode EFFECTIVE_MODE)
 {
+    StatsScope stats(StatsTrigger::Window);
     auto s = getRowForWindow(window);
 
     if (s == nullptr) {
@@ -557,7 +673,8 @@ void ScrollerLayout::fullscreenRequestForWindow(PHLWINDOW window,
     } else {
         if (EFFECTIVE_MODE == CURRENT_EFFECTIVE_MODE)
             return;
-        s->set_fullscreen_mode(window, CURRENT_EFFECTIVE_MODE, EFFECTIVE_MODE);
+        recorder.op("fullscreen", window_id(window), to_fullscreen_mode(CURRENT_EFFECTIVE_MODE), to_fullscreen_mode(EFFECTIVE_MODE));
+        s->set_fullscreen_mode(window_id(window), to_fullscreen_mode(CURRENT_EFFECTIVE_MODE), to_fullscreen_mode(EFFECTIVE_MODE));
     }
     g_pCompositor->changeWindowZOrder(window, true);
 }
@@ -596,14 +713,17 @@ void ScrollerLayout::switchWindows(PHLWINDOW, PHLWINDOW)
 */
 void ScrollerLayout::moveWindowTo(PHLWINDOW window, const std::string &direction, bool /* silent */)
 {
+    StatsScope stats(StatsTrigger::Window);
     auto s = getRowForWindow(window);
     if (s == nullptr) {
         return;
-    } else if (!(s->is_active(window))) {
+    } else if (!(s->is_active(window_id(window)))) {
         // cannot move non active window?
         return;
     }
 
+    recorder.op("movewindowto", window_id(window), direction);
+
     switch (direction.at(0)) {
         case 'l': s->move_active_column(Direction::Left); break;
         case 'r': s->move_active_column(Direction::Right); break;
@@ -612,6 +732,8 @@ void ScrollerLayout::moveWindowTo(PHLWINDOW window, const std::string &direction
         default: break;
     }
 
+    snapshot_changed(true);
+
     // "silent" requires to keep focus in the neighborhood of the moved window
     // before it moved. I ignore it for now.
 }
@@ -657,7 +779,7 @@ PHLWINDOW ScrollerLayout::getNextWindowCandidate(PHLWINDOW/* old_window */)
     if (s == nullptr)
         return nullptr;
     else
-        return s->get_active_window();
+        return hyprland_window(s->get_active_window());
 }
 
 /*
@@ -667,15 +789,8 @@ void ScrollerLayout::replaceWindowDataWith(PHLWINDOW /* from */, PHLWINDOW /* to
 {
 }
 
-static SP<HOOK_CALLBACK_FN> workspaceHookCallback;
-static SP<HOOK_CALLBACK_FN> focusedMonHookCallback;
-static SP<HOOK_CALLBACK_FN> activeWindowHookCallback;
-static SP<HOOK_CALLBACK_FN> swipeBeginHookCallback;
-static SP<HOOK_CALLBACK_FN> swipeUpdateHookCallback;
-static SP<HOOK_CALLBACK_FN> swipeEndHookCallback;
-static SP<HOOK_CALLBACK_FN> mouseMoveHookCallback;
-
 void ScrollerLayout::onEnable() {
+    const auto enable_start = std::chrono::steady_clock::now();
     // Hijack Hyprland's default dispatchers
     orig_moveFocusTo = g_pKeybindManager->m_mDispatchers["movefocus"];
     orig_moveActiveTo = g_pKeybindManager->m_mDispatchers["movewindow"];
@@ -684,57 +799,142 @@ void ScrollerLayout::onEnable() {
 
     // Register dynamic callbacks for events
     workspaceHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "workspace", [&](void* /* self */, SCallbackInfo& /* info */, std::any param) {
+        StatsScope stats(StatsTrigger::FocusChange);
         auto WORKSPACE = std::any_cast<PHLWORKSPACE>(param);
-        post_event(WORKSPACE->m_iID, "mode");
-        post_event(WORKSPACE->m_iID, "overview");
+        post_event(WORKSPACE->m_iID, EventTopic::Mode);
+        post_event(WORKSPACE->m_iID, EventTopic::Overview);
     });
     focusedMonHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "focusedMon", [&](void* /* self */, SCallbackInfo& /* info */, std::any param) {
+        StatsScope stats(StatsTrigger::FocusChange);
         auto monitor = std::any_cast<PHLMONITOR>(param);
-        post_event(monitor->activeWorkspaceID(), "mode");
-        post_event(monitor->activeWorkspaceID(), "overview");
+        post_event(monitor->activeWorkspaceID(), EventTopic::Mode);
+        post_event(monitor->activeWorkspaceID(), EventTopic::Overview);
     });
     activeWindowHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "activeWindow", [&](void* /* self */, SCallbackInfo& /* info */, std::any param) {
+        StatsScope stats(StatsTrigger::FocusChange);
         auto window = std::any_cast<PHLWINDOW>(param);
-        trails->post_trailmark_event(window);
-        marks.post_mark_event(window);
+        trails->post_trailmark_event(window_id(window));
+        marks->post_mark_event(window_id(window));
     });
 
-    swipeBeginHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "swipeBegin", [&](void* /* self */, SCallbackInfo& /* info */, std::any param) {
-        auto swipe_event = std::any_cast<IPointer::SSwipeBeginEvent>(param);
-        swipe_begin(swipe_event);
-    });
-
-    swipeUpdateHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "swipeUpdate", [&](void* /* self */, SCallbackInfo& info, std::any param) {
-        auto swipe_event = std::any_cast<IPointer::SSwipeUpdateEvent>(param);
-        swipe_update(info, swipe_event);
-    });
-
-    swipeEndHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "swipeEnd", [&](void* /* self */, SCallbackInfo& info, std::any param) {
-        auto swipe_event = std::any_cast<IPointer::SSwipeEndEvent>(param);
-        swipe_end(info, swipe_event);
-    });
-
-    mouseMoveHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "mouseMove", [&](void* /* self */, SCallbackInfo& info, std::any param) {
-        Vector2D mousePos = std::any_cast<Vector2D>(param);
-        mouse_move(info, mousePos);
+    configReloadedHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "configReloaded", [&](void* /* self */, SCallbackInfo& /* info */, std::any /* param */) {
+        onConfigReloaded();
     });
 
     enabled = true;
+    adapter.compile_config();
+    updateInputCallbacks();
+    prepareJumpLabels();
     overviews = new Overview;
-    marks.reset();
-    trails = new Trails();
+    if (g_pMoveWindowToWorkspaceSafeHook == nullptr) {
+        auto FNS = HyprlandAPI::findFunctionsByName(PHANDLE, "moveWindowToWorkspaceSafe");
+        if (!FNS.empty())
+            g_pMoveWindowToWorkspaceSafeHook = HyprlandAPI::createFunctionHook(PHANDLE, FNS[0].address, (void *)hookMoveWindowToWorkspaceSafe);
+    }
+    // Without it, moved windows are closed and opened again, like before
+    if (g_pMoveWindowToWorkspaceSafeHook != nullptr)
+        g_pMoveWindowToWorkspaceSafeHook->hook();
+    // Marks and trails survive disabling the layout, like the rows
+    if (marks == nullptr) {
+        marks = new Marks(&adapter);
+        marks->reset();
+        trails = new Trails(&adapter);
+    }
+
+    static auto const *RECORD = (Hyprlang::STRING const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:record")->getDataStaticPtr();
+    const std::string record_path = *RECORD;
+    if (!record_path.empty() && !recorder.is_recording() && recorder.start(record_path))
+        scheduleRecordFlush();
+    recorder.op("enable");
+    if (recorder.is_recording()) {
+        // The rows kept while disabled, for recordings that start here.
+        // Replays that already have these windows ignore them.
+        for (auto row = rows.first(); row != nullptr; row = row->next())
+            recordRow(row->data());
+    }
+
+    // Bulk load the existing windows: build every row first, and lay each
+    // one out once, without animating all the intermediate states.
+    // The rows kept while the layout was disabled are reconciled in the same
+    // pass: windows that are gone, or are not tiled in the row's workspace
+    // any more, leave them, and only windows that are not in any row are
+    // added. Everything else keeps its column, width, group, pin and scroll
+    // position.
+    const bool kept = !rows.empty();
+    const auto tiled = [](const PHLWINDOW &window) {
+        return !window->m_bIsFloating && window->m_bIsMapped && !window->isHidden();
+    };
+    std::vector<WindowAdapter *> windows;
+    for (auto row = rows.first(); row != nullptr;) {
+        auto next = row->next();
+        Row *s = row->data();
+        s->begin_load();
+        windows.clear();
+        s->get_windows(windows);
+        for (auto window : windows) {
+            const auto w = hyprland_window(window);
+            if (w != nullptr && tiled(w) && w->workspaceID() == s->get_workspace())
+                continue;
+            if (!removeWindow(s, window->get_id()))
+                break;
+        }
+        row = next;
+    }
+    std::vector<Row *> loading;
+    std::unordered_set<WindowID> loaded;
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        loading.push_back(row->data());
+        windows.clear();
+        row->data()->get_windows(windows);
+        for (auto window : windows)
+            loaded.insert(window->get_id());
+    }
     for (auto& window : g_pCompositor->m_vWindows) {
-        if (window->m_bIsFloating || !window->m_bIsMapped || window->isHidden())
+        if (!tiled(window) || loaded.contains(window_id(window)))
             continue;
 
-        onWindowCreatedTiling(window);
-    }
+        if (getRowForWorkspace(window->workspaceID()) == nullptr) {
+            Row *s = new Row(window->workspaceID(), &adapter);
+            rows.push_back(s);
+            s->begin_load();
+            loading.push_back(s);
+        }
+        addWindow(window);
+    }
+    // A fresh layout restores the last snapshot, also for the windows that
+    // open in the next minute, like after restarting the compositor
+    restoring.clear();
+    restored.clear();
+    if (!kept && snapshot_enabled() && !snapshot_path().empty() &&
+        read_snapshot(snapshot_path(), restoring)) {
+        restore_deadline = std::chrono::steady_clock::now() + std::chrono::minutes(1);
+        restoreSnapshot(0);
+    }
+    for (auto s : loading) {
+        const auto workspace = g_pCompositor->getWorkspaceByID(s->get_workspace());
+        if (workspace != nullptr) {
+            const auto focused = workspace->getLastFocusedWindow();
+            if (focused != nullptr && s->has_window(window_id(focused))) {
+                recorder.op("focus", window_id(focused));
+                s->focus_window(window_id(focused));
+            }
+        }
+        const MonitorID monitor = workspace != nullptr && workspace->m_pMonitor ?
+            workspace->m_pMonitor->ID : adapter.get_active_monitor();
+        recorder.op("load", s->get_workspace(), monitor);
+        s->update_sizes(monitor);
+        s->end_load();
+    }
+    // Rows are already laid out for their monitors, this only applies
+    // fullscreen states
     for (auto &monitor : g_pCompositor->m_vMonitors) {
         recalculateMonitor(monitor->ID);
     }
+    layout_stats.first_layout(enable_start);
 }
 
 void ScrollerLayout::onDisable() {
+    recorder.op("disable");
     // Restore Hyprland's default dispatchers
     g_pKeybindManager->m_mDispatchers["movefocus"] = orig_moveFocusTo;
     g_pKeybindManager->m_mDispatchers["movewindow"] = orig_moveActiveTo;
@@ -768,17 +968,73 @@ void ScrollerLayout::onDisable() {
         mouseMoveHookCallback.reset();
         mouseMoveHookCallback = nullptr;
     }
+    if (configReloadedHookCallback != nullptr) {
+        configReloadedHookCallback.reset();
+        configReloadedHookCallback = nullptr;
+    }
 
+    // Keep the rows, marks and trails as a shadow of the layout, so enabling
+    // it again only reconciles the windows that changed in the meantime,
+    // instead of rebuilding every row. Overviews and selections are scroller
+    // rendering state, and don't outlive it.
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        if (row->data()->is_overview())
+            toggle_overview(row->data()->get_workspace());
+    }
+    selection_reset();
+    if (g_pMoveWindowToWorkspaceSafeHook != nullptr)
+        g_pMoveWindowToWorkspaceSafeHook->unhook();
+    closeDetached();
+    flushDeferred();
+    if (idle != nullptr) {
+        wl_event_source_remove(idle);
+        idle = nullptr;
+    }
+    if (motion_idle != nullptr) {
+        wl_event_source_remove(motion_idle);
+        motion_idle = nullptr;
+    }
+    if (hover_timer != nullptr) {
+        wl_event_source_remove(hover_timer);
+        hover_timer = nullptr;
+    }
+    pointer_motion = false;
+    hover_window = 0;
+    // Unloading the plugin disables the layout first
+    snapshot_write();
     if (overviews != nullptr) {
         delete overviews;
         overviews = nullptr;
     }
     enabled = false;
+}
+
+ScrollerLayout::~ScrollerLayout() {
+    if (snapshot_timer != nullptr)
+        wl_event_source_remove(snapshot_timer);
+    if (record_timer != nullptr)
+        wl_event_source_remove(record_timer);
+    if (idle != nullptr)
+        wl_event_source_remove(idle);
+    if (motion_idle != nullptr)
+        wl_event_source_remove(motion_idle);
+    if (hover_timer != nullptr)
+        wl_event_source_remove(hover_timer);
+    closeDetached();
+    std::vector<WindowAdapter *> windows;
     for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        row->data()->get_windows(windows);
         delete row->data();
     }
     rows.clear();
-    marks.reset();
+    for (auto window : windows) {
+        delete window;
+    }
+    if (marks != nullptr) {
+        marks->reset();
+        delete marks;
+        marks = nullptr;
+    }
     delete trails;
     trails = nullptr;
 }
@@ -804,6 +1060,7 @@ Vector2D ScrollerLayout::predictSizeForNewWindowTiled() {
 
 void ScrollerLayout::cycle_window_size(WORKSPACEID workspace, int step)
 {
+    recorder.op("cyclesize", workspace, step);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -814,6 +1071,7 @@ void ScrollerLayout::cycle_window_size(WORKSPACEID workspace, int step)
 
 void ScrollerLayout::cycle_window_width(WORKSPACEID workspace, int step)
 {
+    recorder.op("cyclewidth", workspace, step);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -827,6 +1085,7 @@ void ScrollerLayout::cycle_window_width(WORKSPACEID workspace, int step)
 
 void ScrollerLayout::cycle_window_height(WORKSPACEID workspace, int step)
 {
+    recorder.op("cycleheight", workspace, step);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -840,6 +1099,7 @@ void ScrollerLayout::cycle_window_height(WORKSPACEID workspace, int step)
 
 void ScrollerLayout::set_window_size(WORKSPACEID workspace, const std::string &arg)
 {
+    recorder.op("setsize", workspace, arg);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -850,6 +1110,7 @@ void ScrollerLayout::set_window_size(WORKSPACEID workspace, const std::string &a
 
 void ScrollerLayout::set_window_width(WORKSPACEID workspace, const std::string &arg)
 {
+    recorder.op("setwidth", workspace, arg);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -863,6 +1124,7 @@ void ScrollerLayout::set_window_width(WORKSPACEID workspace, const std::string &
 
 void ScrollerLayout::set_window_height(WORKSPACEID workspace, const std::string &arg)
 {
+    recorder.op("setheight", workspace, arg);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -877,6 +1139,7 @@ void ScrollerLayout::set_window_height(WORKSPACEID workspace, const std::string
 void ScrollerLayout::move_focus(WORKSPACEID workspace, Direction direction)
 {
     static auto* const *focus_wrap = (Hyprlang::INT* const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:focus_wrap")->getDataStaticPtr();
+    recorder.op("movefocus", workspace, direction, **focus_wrap != 0);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         // if workspace is empty, use the deault movefocus, which now
@@ -900,7 +1163,7 @@ void ScrollerLayout::move_focus(WORKSPACEID workspace, Direction direction)
         return;
     }
 
-    auto from = s->get_active_window();
+    auto from = hyprland_window(s->get_active_window());
     update_relative_cursor_coords(from);
 
     if (s->move_focus(direction, **focus_wrap == 0 ? false : true)) {
@@ -909,16 +1172,18 @@ void ScrollerLayout::move_focus(WORKSPACEID workspace, Direction direction)
         if (!workspace_id) {
             workspace_id = g_pCompositor->m_pLastMonitor->activeWorkspaceID();
         }
+        recorder.op("recalculate", workspace_id);
         s = getRowForWorkspace(workspace_id);
         if (s != nullptr) {
             s->recalculate_row_geometry();
         }
     }
-    PHLWINDOW to = s != nullptr ? s->get_active_window() : nullptr;
+    PHLWINDOW to = s != nullptr ? hyprland_window(s->get_active_window()) : nullptr;
     switch_to_window(from, to);
 }
 
 void ScrollerLayout::move_window(WORKSPACEID workspace, Direction direction, bool nomode) {
+    recorder.op("movewindow", workspace, direction, nomode);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -931,6 +1196,7 @@ void ScrollerLayout::move_window(WORKSPACEID workspace, Direction direction, boo
 }
 
 void ScrollerLayout::align_window(WORKSPACEID workspace, Direction direction) {
+    recorder.op("alignwindow", workspace, direction);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -940,6 +1206,7 @@ void ScrollerLayout::align_window(WORKSPACEID workspace, Direction direction) {
 }
 
 void ScrollerLayout::admit_window(WORKSPACEID workspace, AdmitExpelDirection direction) {
+    recorder.op("admitwindow", workspace, direction);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -948,6 +1215,7 @@ void ScrollerLayout::admit_window(WORKSPACEID workspace, AdmitExpelDirection dir
 }
 
 void ScrollerLayout::expel_window(WORKSPACEID workspace, AdmitExpelDirection direction) {
+    recorder.op("expelwindow", workspace, direction);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -956,6 +1224,7 @@ void ScrollerLayout::expel_window(WORKSPACEID workspace, AdmitExpelDirection dir
 }
 
 void ScrollerLayout::set_mode(WORKSPACEID workspace, Mode mode) {
+    recorder.op("setmode", workspace, mode);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -964,6 +1233,11 @@ void ScrollerLayout::set_mode(WORKSPACEID workspace, Mode mode) {
 }
 
 void ScrollerLayout::set_mode_modifier(WORKSPACEID workspace, const ModeModifier &modifier) {
+    // Undefined center options are recorded as -1
+    recorder.op("setmodemodifier", workspace, modifier.get_position(false), modifier.get_focus(false),
+                modifier.get_auto_mode(false), modifier.get_auto_param(),
+                modifier.get_center_column().has_value() ? (int)*modifier.get_center_column() : -1,
+                modifier.get_center_window().has_value() ? (int)*modifier.get_center_window() : -1);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -972,6 +1246,7 @@ void ScrollerLayout::set_mode_modifier(WORKSPACEID workspace, const ModeModifier
 }
 
 void ScrollerLayout::fit_size(WORKSPACEID workspace, FitSize fitsize) {
+    recorder.op("fitsize", workspace, fitsize);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -980,6 +1255,7 @@ void ScrollerLayout::fit_size(WORKSPACEID workspace, FitSize fitsize) {
 }
 
 void ScrollerLayout::fit_width(WORKSPACEID workspace, FitSize fitsize) {
+    recorder.op("fitwidth", workspace, fitsize);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -991,6 +1267,7 @@ void ScrollerLayout::fit_width(WORKSPACEID workspace, FitSize fitsize) {
 }
 
 void ScrollerLayout::fit_height(WORKSPACEID workspace, FitSize fitsize) {
+    recorder.op("fitheight", workspace, fitsize);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -1002,6 +1279,7 @@ void ScrollerLayout::fit_height(WORKSPACEID workspace, FitSize fitsize) {
 }
 
 void ScrollerLayout::toggle_overview(WORKSPACEID workspace) {
+    recorder.op("toggleoverview", workspace);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -1014,84 +1292,106 @@ PHLWINDOW ScrollerLayout::getActiveWindow(WORKSPACEID workspace) {
     if (s == nullptr)
         return nullptr;
 
-    return s->get_active_window();
+    return hyprland_window(s->get_active_window());
 }
 
 void ScrollerLayout::marks_add(const std::string &name) {
+    recorder.op("marksadd", name);
     PHLWINDOW window = getActiveWindow(get_workspace_id());
     if (window != nullptr)
-        marks.add(window, name);
+        marks->add(window_id(window), name);
 }
 
 void ScrollerLayout::marks_delete(const std::string &name) {
-    marks.del(name);
+    recorder.op("marksdelete", name);
+    marks->del(name, window_id(g_pCompositor->m_pLastWindow.lock()));
 }
 
 void ScrollerLayout::marks_visit(const std::string &name) {
+    recorder.op("marksvisit", name);
     PHLWINDOW from = getActiveWindow(get_workspace_id());
     update_relative_cursor_coords(from);
-    PHLWINDOW to = marks.visit(name);
+    PHLWINDOW to = getWindow(marks->visit(name));
     if (to != nullptr) {
         switch_to_window(from, to);
     }
 }
 
 void ScrollerLayout::marks_reset() {
-    marks.reset();
+    recorder.op("marksreset");
+    marks->reset();
 }
 
 // Trails and Trailmarks
 void ScrollerLayout::trail_new() {
+    recorder.op("trailnew");
     trails->trail_new();
 }
 
 void ScrollerLayout::trail_next() {
+    recorder.op("trailnext");
     trails->trail_next();
 }
 
 void ScrollerLayout::trail_prev() {
+    recorder.op("trailprevious");
     trails->trail_prev();
 }
 
 void ScrollerLayout::trail_delete() {
+    recorder.op("traildelete");
     trails->trail_delete();
 }
 
 void ScrollerLayout::trail_clear() {
+    recorder.op("trailclear");
     trails->trail_clear();
 }
 
 void ScrollerLayout::trail_toselection() {
-    trails->trail_toselection();
+    recorder.op("trailtoselection");
+    std::vector<WindowID> windows;
+    trails->get_active_windows(windows);
+    if (windows.empty())
+        return;
+    for (auto id : windows) {
+        PHLWINDOW window = getWindow(id);
+        if (window != nullptr)
+            selection_set(window);
+    }
 }
 
 void ScrollerLayout::trailmark_toggle() {
+    recorder.op("trailmarktoggle");
     PHLWINDOW window = getActiveWindow(get_workspace_id());
     if (window != nullptr)
-        trails->trailmark_toggle(window);
+        trails->trailmark_toggle(window_id(window));
 }
 
 void ScrollerLayout::trailmark_next() {
+    recorder.op("trailmarknext");
     trails->trailmark_next();
     PHLWINDOW from = getActiveWindow(get_workspace_id());
     update_relative_cursor_coords(from);
-    PHLWINDOW to = trails->get_active();
+    PHLWINDOW to = getWindow(trails->get_active());
     if (to != nullptr) {
         switch_to_window(from, to);
     }
 }
 
 void ScrollerLayout::trailmark_prev() {
+    recorder.op("trailmarkprevious");
     trails->trailmark_prev();
     PHLWINDOW from = getActiveWindow(get_workspace_id());
     update_relative_cursor_coords(from);
-    PHLWINDOW to = trails->get_active();
+    PHLWINDOW to = getWindow(trails->get_active());
     if (to != nullptr) {
         switch_to_window(from, to);
     }
 }
 
 void ScrollerLayout::pin(WORKSPACEID workspace) {
+    recorder.op("pin", workspace);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
@@ -1101,49 +1401,45 @@ void ScrollerLayout::pin(WORKSPACEID workspace) {
 }
 
 void ScrollerLayout::selection_toggle(WORKSPACEID workspace) {
+    recorder.op("selectiontoggle", workspace);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
     }
 
+    // The window damages its border
     s->selection_toggle();
-
-    // Re-render that monitor to remove decorations
-    g_pHyprRenderer->damageMonitor(g_pCompositor->m_pLastMonitor.lock());
 }
 
-void ScrollerLayout::selection_set(PHLWINDOWREF window) {
+void ScrollerLayout::selection_set(PHLWINDOW window) {
+    recorder.op("selectionset", window_id(window));
     for (auto row = rows.first(); row != nullptr; row = row->next()) {
-        row->data()->selection_set(window);
+        row->data()->selection_set(window_id(window));
     }
 }
 
 void ScrollerLayout::selection_reset() {
+    recorder.op("selectionreset");
     for (auto row = rows.first(); row != nullptr; row = row->next()) {
         row->data()->selection_reset();
     }
-    // Re-render windows to remove decorations
-    for (auto monitor : g_pCompositor->m_vMonitors) {
-        g_pHyprRenderer->damageMonitor(monitor);
-    }
 }
 
 void ScrollerLayout::selection_workspace(WORKSPACEID workspace) {
+    recorder.op("selectionworkspace", workspace);
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
     }
 
     s->selection_all();
-
-    // Re-render that monitor to render decorations
-    g_pHyprRenderer->damageMonitor(g_pCompositor->m_pLastMonitor.lock());
 }
 
 // Move all selected columns/windows to workspace, and locate them in direction wrt
 // the active column. Valid directiona are left, right, beginning, end, other
 // defaults to right.
 void ScrollerLayout::selection_move(WORKSPACEID workspace, Direction direction) {
+    recorder.op("selectionmove", workspace, direction);
     // Before doing anything complicated, first checkt if there is any selection active
     bool selection = false;
     for (auto row = rows.first(); row != nullptr; row = row->next()) {
@@ -1158,7 +1454,7 @@ void ScrollerLayout::selection_move(WORKSPACEID workspace, Direction direction)
     auto s = getRowForWorkspace(workspace);
     bool overview_on = false;
     if (s == nullptr) {
-        s = new Row(workspace);
+        s = new Row(workspace, &adapter);
         rows.push_back(s);
     } else {
         overview_on = s->is_overview();
@@ -1186,13 +1482,13 @@ void ScrollerLayout::selection_move(WORKSPACEID workspace, Direction direction)
     while (row != nullptr) {
         auto next = row->next();
         if (row->data()->size() == 0) {
-            rows.erase(row);
             delete row->data();
+            rows.erase(row);
         } else {
             bool overview = row->data()->is_overview();
             if (overview)
                 row->data()->toggle_overview();
-            g_pCompositor->focusWindow(row->data()->get_active_window());
+            g_pCompositor->focusWindow(hyprland_window(row->data()->get_active_window()));
             row->data()->recalculate_row_geometry();
             if (overview)
                 row->data()->toggle_overview();
@@ -1200,7 +1496,7 @@ void ScrollerLayout::selection_move(WORKSPACEID workspace, Direction direction)
         row = next;
     }
 
-    g_pCompositor->focusWindow(s->get_active_window());
+    g_pCompositor->focusWindow(hyprland_window(s->get_active_window()));
     // Reset selection
     selection_reset();
 
@@ -1217,12 +1513,21 @@ typedef struct JumpData {
     PHLMONITORREF from_monitor;
     std::vector<Rows> workspaces;
     std::vector<PHLWINDOWREF> windows;
-    std::vector<JumpDecoration *> decorations;
+    std::vector<std::string> labels;
     std::string keys;
+    // Keysym of each label key, the index is its digit
+    std::vector<xkb_keysym_t> keysyms;
     int keys_pressed = 0;
     int nkeys;
-    unsigned int window_number = 0;
+    // Labels are nkeys digit numbers in base keys.size(), so the windows
+    // whose labels start with the keys pressed so far are the range
+    // [first, last), and every key narrows it to one of keys.size()
+    // blocks: an implicit trie.
+    size_t first = 0;
+    size_t last = 0;
+    size_t block = 1;
     SP<HOOK_CALLBACK_FN> keyPressHookCallback;
+    SP<HOOK_CALLBACK_FN> renderHookCallback;
 } JumpData;
 
 static JumpData *jump_data;
@@ -1239,7 +1544,83 @@ static std::string generate_label(unsigned int i, const std::string &keys, unsig
     return label;
 }
 
+// Label box of window, in global coordinates: a square centred in the window
+// and scaled by jump_labels_scale
+static CBox jump_label_box(PHLWINDOW window)
+{
+    static auto *const *TEXTSCALE = (Hyprlang::FLOAT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:jump_labels_scale")->getDataStaticPtr();
+    CBox box = { window->m_vRealPosition->value(), window->m_vRealSize->value() };
+    if (box.w > box.h) {
+        box.x += 0.5 * (box.w - box.h);
+        box.w = box.h;
+    } else {
+        box.y += 0.5 * (box.h - box.w);
+        box.h = box.w;
+    }
+    const double scale = **TEXTSCALE < 0.1 ? 0.1 : **TEXTSCALE > 1.0 ? 1.0 : **TEXTSCALE;
+    box.scaleFromCenter(scale);
+    if (window->m_pWorkspace != nullptr)
+        box.translate(window->m_pWorkspace->m_vRenderOffset->value());
+    return box;
+}
+
+// Adds the labels still matching of the windows on the monitor being
+// rendered, after its windows
+static void render_jump_labels(JumpLabels *glyphs)
+{
+    const auto monitor = g_pHyprOpenGL->m_RenderData.pMonitor.lock();
+    if (monitor == nullptr)
+        return;
+    std::vector<JumpPassElement::Label> labels;
+    for (size_t i = jump_data->first; i < jump_data->last; ++i) {
+        const auto window = jump_data->windows[i].lock();
+        if (window == nullptr || window->m_pWorkspace == nullptr || window->m_pWorkspace->m_pMonitor.lock() != monitor)
+            continue;
+        CBox box = jump_label_box(window).translate(-monitor->vecPosition).scale(monitor->scale).round();
+        if (box.width < 1 || box.height < 1)
+            continue;
+        labels.push_back({ box, jump_data->labels[i] });
+    }
+    if (!labels.empty())
+        g_pHyprRenderer->m_sRenderPass.add(makeShared<JumpPassElement>(glyphs, std::move(labels)));
+}
+
+// Damages the monitors of the rows in jump mode
+static void damage_jump_monitors()
+{
+    for (auto workspace : jump_data->workspaces) {
+        const auto PWORKSPACE = g_pCompositor->getWorkspaceByID(workspace.row->get_workspace());
+        const auto PMONITOR = PWORKSPACE != nullptr ? PWORKSPACE->m_pMonitor.lock() : nullptr;
+        if (PMONITOR != nullptr)
+            g_pHyprRenderer->damageMonitor(PMONITOR);
+    }
+}
+
+// Damages the labels in [first, last) that are no longer in the range
+// jump_data matches. In overview, the monitor scale is multiplied by the
+// overview scale while rendering, so scale their boxes the same way.
+static void damage_jump_labels(size_t first, size_t last)
+{
+    for (size_t i = first; i < last; ++i) {
+        if (i >= jump_data->first && i < jump_data->last)
+            continue;
+        const auto window = jump_data->windows[i].lock();
+        if (window == nullptr || window->m_pWorkspace == nullptr)
+            continue;
+        const auto monitor = window->m_pWorkspace->m_pMonitor.lock();
+        if (monitor == nullptr)
+            continue;
+        CBox box = jump_label_box(window);
+        const WORKSPACEID workspace = window->workspaceID();
+        if (overviews->overview_enabled(workspace))
+            box.translate(-monitor->vecPosition).scale(overviews->get_scale(workspace)).translate(monitor->vecPosition);
+        // Rendering rounds the box to whole pixels
+        g_pHyprRenderer->damageBox(box.expand(1));
+    }
+}
+
 void ScrollerLayout::jump() {
+    recorder.op("jump");
     if (jumping)
         return;
 
@@ -1263,8 +1644,12 @@ void ScrollerLayout::jump() {
         return;
     }
 
+    std::vector<WindowAdapter *> windows;
     for (auto workspace : jump_data->workspaces) {
-        workspace.row->get_windows(jump_data->windows);
+        workspace.row->get_windows(windows);
+    }
+    for (auto window : windows) {
+        jump_data->windows.push_back(hyprland_window(window));
     }
     if (jump_data->windows.size() == 0) {
         delete jump_data;
@@ -1277,15 +1662,26 @@ void ScrollerLayout::jump() {
     jump_data->from_window = g_pCompositor->m_pLastWindow;
     jump_data->from_monitor = g_pCompositor->m_pLastMonitor;
 
-    if (jump_data->keys.size() == 1 && jump_data->windows.size() > 1) {
+    if (jump_data->keys.empty() || (jump_data->keys.size() == 1 && jump_data->windows.size() > 1)) {
         delete jump_data;
         jumping = false;
         return;
     }
-    if (jump_data->windows.size() == 1)
-        jump_data->nkeys = 1;
-    else
-        jump_data->nkeys = std::ceil(std::log10(jump_data->windows.size()) / std::log10(jump_data->keys.size()));
+    for (auto key : jump_data->keys) {
+        const std::string keyname(1, key);
+        jump_data->keysyms.push_back(xkb_keysym_from_name(keyname.c_str(), XKB_KEYSYM_NO_FLAGS));
+    }
+    // Fewest digits that label every window
+    jump_data->nkeys = 1;
+    jump_data->block = jump_data->keys.size();
+    while (jump_data->block < jump_data->windows.size()) {
+        jump_data->nkeys++;
+        jump_data->block *= jump_data->keys.size();
+    }
+    jump_data->first = 0;
+    jump_data->last = jump_data->windows.size();
+    // Nothing to do unless the options changed without a reload
+    prepareJumpLabels();
 
     // Set overview mode for those workspaces that are not
     for (auto workspace : jump_data->workspaces) {
@@ -1294,17 +1690,17 @@ void ScrollerLayout::jump() {
         }
     }
 
-    // Set decorations (in overview mode)
-    int i = 0;
-    for (auto window : jump_data->windows) {
-        const std::string label = generate_label(i++, jump_data->keys, jump_data->nkeys);
-        auto deco = makeUnique<JumpDecoration>(window.lock(), label);
-        jump_data->decorations.push_back(deco.get());
-        HyprlandAPI::addWindowDecoration(PHANDLE, window.lock(), std::move(deco));
+    // Labels are drawn by one pass element per monitor, after the windows
+    for (size_t i = 0; i < jump_data->windows.size(); ++i) {
+        jump_data->labels.push_back(generate_label(i, jump_data->keys, jump_data->nkeys));
     }
+    jump_data->renderHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "render", [&](void* /* self */, SCallbackInfo& /* info */, std::any param) {
+        if (std::any_cast<eRenderStage>(param) == eRenderStage::RENDER_POST_WINDOWS)
+            render_jump_labels(&jump_labels);
+    });
+    damage_jump_monitors();
 
     jump_data->keys_pressed = 0;
-    jump_data->window_number = 0;
 
     jump_data->keyPressHookCallback = HyprlandAPI::registerCallbackDynamic(PHANDLE, "keyPress", [&](void* /* self */, SCallbackInfo& info, std::any param) {
         auto keypress_event = std::any_cast<std::unordered_map<std::string, std::any>>(param);
@@ -1318,32 +1714,29 @@ void ScrollerLayout::jump() {
             return;
 
         // Check if key is valid, otherwise exit
-        bool valid = false;
-        for (int i = 0; i < jump_data->keys.size(); ++i) {
-            std::string keyname(1, jump_data->keys[i]);
-            xkb_keysym_t key = xkb_keysym_from_name(keyname.c_str(), XKB_KEYSYM_NO_FLAGS);
-            if (key && key == keysym) {
-                jump_data->window_number = jump_data->window_number * jump_data->keys.size() + i;
-                valid = true;
-                break;
-            }
-        }
+        const auto key = std::find(jump_data->keysyms.begin(), jump_data->keysyms.end(), keysym);
         bool focus = false;
-        if (valid) {
+        if (keysym != XKB_KEY_NoSymbol && key != jump_data->keysyms.end()) {
+            const size_t first = jump_data->first;
+            const size_t last = jump_data->last;
+            jump_data->block /= jump_data->keys.size();
+            jump_data->first += (key - jump_data->keysyms.begin()) * jump_data->block;
+            jump_data->last = std::min(jump_data->first + jump_data->block, last);
             jump_data->keys_pressed++;
-            if (jump_data->keys_pressed == jump_data->nkeys) {
-                if (jump_data->window_number < jump_data->windows.size())
+            if (jump_data->first < jump_data->last) {
+                if (jump_data->keys_pressed == jump_data->nkeys) {
                     focus = true;
-            } else {
-                info.cancelled = true;
-                return;
+                } else {
+                    damage_jump_labels(first, last);
+                    info.cancelled = true;
+                    return;
+                }
             }
         }
 
-        // Finished, remove decorations
-        for (size_t i = 0; i < jump_data->windows.size(); ++i) {
-            jump_data->windows[i]->removeWindowDeco(jump_data->decorations[i]);
-        }
+        // Finished, remove the labels
+        jump_data->renderHookCallback.reset();
+        damage_jump_monitors();
 
         // Restore original overview
         for (auto workspace : jump_data->workspaces) {
@@ -1354,7 +1747,7 @@ void ScrollerLayout::jump() {
         if (focus) {
             update_relative_cursor_coords(jump_data->from_window.lock());
             switch_to_window(jump_data->from_window.lock(),
-                             jump_data->windows[jump_data->window_number].lock());
+                             jump_data->windows[jump_data->first].lock());
         } else {
             if (jump_data->from_window != nullptr)
                 jump_data->from_window->warpCursor();
@@ -1370,16 +1763,208 @@ void ScrollerLayout::jump() {
     });
 }
 
-void ScrollerLayout::post_event(WORKSPACEID workspace, const std::string &event) {
+std::string ScrollerLayout::stats(bool json) {
+    std::vector<std::pair<WorkspaceID, StructureStats>> workspaces;
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        StructureStats workspace;
+        row->data()->get_stats(workspace);
+        // The node in rows, the adapters and the selection borders of the
+        // selected windows
+        workspace.list_nodes++;
+        workspace.bytes += sizeof(ListNode<Row *>) + workspace.windows * sizeof(HyprlandWindow);
+        std::vector<WindowAdapter *> windows;
+        row->data()->get_windows(windows);
+        workspace.decorations = std::count_if(windows.begin(), windows.end(), [](WindowAdapter *window) {
+            return static_cast<HyprlandWindow *>(window)->is_selected();
+        });
+        workspace.decoration_bytes = workspace.decorations * sizeof(SelectionBorders);
+        workspaces.push_back({ row->data()->get_workspace(), workspace });
+    }
+    return layout_stats.report(workspaces, json);
+}
+
+// Start recording. If there are windows in the layout already, write them
+// first, one per column in the order they appear, so the replay starts with
+// the same windows even though it cannot rebuild the exact columns.
+bool ScrollerLayout::record_start(const std::string &path) {
+    if (!recorder.start(path))
+        return false;
+    scheduleRecordFlush();
+    if (!enabled)
+        return true;
+
+    adapter.get_config();
+    adapter.get_sizes();
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        recordRow(row->data());
+        auto active = row->data()->get_active_window();
+        if (active != nullptr)
+            recorder.op("focus", active->get_id());
+    }
+    for (auto &monitor : g_pCompositor->m_vMonitors) {
+        recalculateMonitor(monitor->ID);
+    }
+    return true;
+}
+
+void ScrollerLayout::recordRow(Row *s) {
+    const WorkspaceID workspace = s->get_workspace();
+    std::vector<WindowAdapter *> windows;
+    s->get_windows(windows);
+    bool first = true;
+    for (auto window : windows) {
+        // Rows kept while the layout was disabled may have windows that are gone
+        if (hyprland_window(window) == nullptr)
+            continue;
+        recorder.window_open(workspace, window, static_cast<HyprlandWindow *>(window)->get_all_rules());
+        if (first) {
+            adapter.get_viewport(adapter.get_active_monitor(), workspace);
+            first = false;
+        }
+    }
+}
+
+void ScrollerLayout::record_stop() {
+    recorder.stop();
+}
+
+void ScrollerLayout::scheduleRecordFlush() {
+    if (record_timer == nullptr)
+        record_timer = wl_event_loop_add_timer(g_pCompositor->m_sWLEventLoop, ::record_timer_fired, this);
+    wl_event_source_timer_update(record_timer, 1000);
+}
+
+void ScrollerLayout::record_flush() {
+    recorder.flush();
+    if (recorder.is_recording())
+        wl_event_source_timer_update(record_timer, 1000);
+}
+
+void ScrollerLayout::snapshot_changed(bool user) {
+    if (user) {
+        restoring.clear();
+        restored.clear();
+    }
+    if (snapshot_scheduled || !enabled || g_pCompositor->m_bIsShuttingDown || !snapshot_enabled())
+        return;
+    if (snapshot_timer == nullptr)
+        snapshot_timer = wl_event_loop_add_timer(g_pCompositor->m_sWLEventLoop, ::snapshot_timer_fired, this);
+    // Every change in the next second goes in the same snapshot
+    wl_event_source_timer_update(snapshot_timer, 1000);
+    snapshot_scheduled = true;
+}
+
+void ScrollerLayout::snapshot_write() {
+    snapshot_scheduled = false;
+    if (!enabled || g_pCompositor->m_bIsShuttingDown || !snapshot_enabled() || snapshot_path().empty())
+        return;
+    if (!restoring.empty()) {
+        // Writing now would lose the windows that are not back yet
+        if (std::chrono::steady_clock::now() < restore_deadline) {
+            snapshot_changed(false);
+            return;
+        }
+        restoring.clear();
+        restored.clear();
+    }
+
+    Snapshot snapshot;
+    std::vector<WindowAdapter *> windows;
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        const Row *s = row->data();
+        SnapshotRow &saved = snapshot.rows.emplace_back();
+        s->save(saved);
+        const auto workspace = g_pCompositor->getWorkspaceByID(s->get_workspace());
+        if (workspace != nullptr)
+            saved.workspace_name = workspace->m_szName;
+        // Same order as the columns and their windows
+        windows.clear();
+        row->data()->get_windows(windows);
+        size_t i = 0;
+        for (auto &column : saved.columns) {
+            for (auto &window : column.windows)
+                window.key = window_key(windows[i++]);
+        }
+    }
+    // Closing every window before restarting keeps the last arrangement
+    if (snapshot.empty())
+        return;
+    marks->save(snapshot.marks);
+    trails->save(snapshot);
+
+    std::string data;
+    snapshot.serialize(data);
+    if (data == snapshot_data)
+        return;
+    snapshot_data = data;
+    snapshot_writer.write(snapshot_path(), std::move(data));
+}
+
+void ScrollerLayout::restoreSnapshot(WindowID window) {
+    // Named workspaces get new ids when the compositor restarts
+    auto row_for = [this](const SnapshotRow &saved) {
+        const auto workspace = saved.workspace_name.empty() ? nullptr : g_pCompositor->getWorkspaceByName(saved.workspace_name);
+        return getRowForWorkspace(workspace != nullptr ? workspace->m_iID : saved.workspace);
+    };
+    std::vector<WindowKey> live;
+    std::vector<WindowAdapter *> windows;
+    Row *target = nullptr;
+    const SnapshotRow *target_saved = nullptr;
+    if (window != 0) {
+        target = getRowForWindow(getWindow(window));
+        if (target == nullptr)
+            return;
+        // A new window can only take the place of a window saved in its
+        // workspace, which is the only row restored
+        for (const auto &saved : restoring.rows) {
+            if (row_for(saved) == target) {
+                target_saved = &saved;
+                break;
+            }
+        }
+        if (target_saved == nullptr)
+            return;
+        live.push_back(window_key(target->get_window(window)));
+    } else {
+        for (auto row = rows.first(); row != nullptr; row = row->next()) {
+            windows.clear();
+            row->data()->get_windows(windows);
+            for (auto w : windows)
+                live.push_back(window_key(w));
+        }
+    }
+    const size_t matched = restored.size();
+    restoring.match(live, restored, target_saved);
+    if (restored.size() == matched)
+        return;
+
+    size_t total = 0;
+    for (const auto &saved : restoring.rows) {
+        for (const auto &column : saved.columns)
+            total += column.windows.size();
+        Row *s = row_for(saved);
+        if (s != nullptr && (target == nullptr || s == target))
+            s->restore(saved, restored);
+    }
+    marks->restore(restoring.marks, restored);
+    trails->restore(restoring, restored);
+    if (restored.size() == total) {
+        restoring.clear();
+        restored.clear();
+    }
+}
+
+void ScrollerLayout::post_event(WORKSPACEID workspace, EventTopic topic) {
     auto s = getRowForWorkspace(workspace);
     if (s == nullptr) {
         return;
     }
 
-    s->post_event(event);
+    s->post_event(topic);
 }
 
 void ScrollerLayout::swipe_begin(IPointer::SSwipeBeginEvent /* swipe_event */) {
+    StatsScope stats(StatsTrigger::Gesture);
     WORKSPACEID wid = get_workspace_id();
     if (wid == -1) {
         return;
@@ -1390,6 +1975,7 @@ void ScrollerLayout::swipe_begin(IPointer::SSwipeBeginEvent /* swipe_event */) {
 }
 
 void ScrollerLayout::swipe_update(SCallbackInfo &info, IPointer::SSwipeUpdateEvent swipe_event) {
+    StatsScope stats(StatsTrigger::Gesture);
     WORKSPACEID wid = get_workspace_id();
     if (wid == -1) {
         return;
@@ -1441,6 +2027,7 @@ void ScrollerLayout::swipe_update(SCallbackInfo &info, IPointer::SSwipeUpdateEve
             swipe_direction = gesture_delta.x > 0 ? Direction::Right : Direction::Left;
         else
             swipe_direction = gesture_delta.y > 0 ? Direction::Down : Direction::Up;
+        recorder.op("scroll", wid, swipe_direction, delta);
         s->scroll_update(swipe_direction, delta);
     } else {
         // Undo natural
@@ -1453,12 +2040,14 @@ void ScrollerLayout::swipe_update(SCallbackInfo &info, IPointer::SSwipeUpdateEve
                 if (s == nullptr)
                     return;
                 if (!s->is_overview()) {
+                    recorder.op("toggleoverview", wid);
                     s->toggle_overview();
                 }
             } else if (delta.y >= **ODISTANCE) {
                 if (s == nullptr)
                     return;
                 if (s->is_overview()) {
+                    recorder.op("toggleoverview", wid);
                     s->toggle_overview();
                 }
             }
@@ -1481,6 +2070,7 @@ void ScrollerLayout::swipe_update(SCallbackInfo &info, IPointer::SSwipeUpdateEve
 
 void ScrollerLayout::swipe_end(SCallbackInfo &info,
                                IPointer::SSwipeEndEvent /* swipe_event */) {
+    StatsScope stats(StatsTrigger::Gesture);
     WORKSPACEID wid = get_workspace_id();
     if (wid == -1) {
         return;
@@ -1488,6 +2078,7 @@ void ScrollerLayout::swipe_end(SCallbackInfo &info,
     // Only if scrolling
     if (swipe_direction != Direction::Begin) {
         auto s = getRowForWorkspace(wid);
+        recorder.op("scrollend", wid, swipe_direction);
         s->scroll_end(swipe_direction);
     }
 
@@ -1497,7 +2088,43 @@ void ScrollerLayout::swipe_end(SCallbackInfo &info,
     info.cancelled = true;
 }
 
+void ScrollerLayout::hover_timer_fired()
+{
+    StatsScope stats(StatsTrigger::FocusChange);
+    const WindowID id = hover_window;
+    hover_window = 0;
+    const auto window = g_pCompositor->m_pLastWindow.lock();
+    if (id == 0 || window == nullptr || window_id(window) != id)
+        return;
+    auto s = getRowForWindow(window);
+    if (s == nullptr)
+        return;
+    recorder.op("recalculate", s->get_workspace());
+    s->recalculate_row_geometry();
+    hover_scroll = std::chrono::steady_clock::now();
+}
+
+void ScrollerLayout::motion_idle_fired()
+{
+    // The event loop removes idle sources after calling them
+    motion_idle = nullptr;
+    pointer_motion = false;
+}
+
 void ScrollerLayout::mouse_move(SCallbackInfo& info, const Vector2D &mousePos) {
+    StatsScope stats(StatsTrigger::Gesture);
+    // Hyprland focuses the window under the pointer after this event, in
+    // the same dispatch
+    static auto *const *HOVER = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:focus_hover_ms")->getDataStaticPtr();
+    if (**HOVER > 0) {
+        pointer_motion = true;
+        if (motion_idle == nullptr)
+            motion_idle = wl_event_loop_add_idle(g_pCompositor->m_sWLEventLoop, ::motion_idle_fired, this);
+    }
+    static auto *const *TIMEOUT = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:focus_edge_ms")->getDataStaticPtr();
+    if (**TIMEOUT <= 0)
+        return;
+
     static bool inside = false;
     auto PMONITOR = g_pCompositor->getMonitorFromVector(mousePos);
     WORKSPACEID workspace_id = PMONITOR->activeWorkspaceID();
@@ -1508,7 +2135,6 @@ void ScrollerLayout::mouse_move(SCallbackInfo& info, const Vector2D &mousePos) {
 
         if (!s->get_max().contains_point(mousePos) && box.contains_point(mousePos)) {
             // We are in gaps_out territory
-            static auto *const *TIMEOUT = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:focus_edge_ms")->getDataStaticPtr();
             static auto enteredTime = std::chrono::high_resolution_clock::now();
             auto eventTime = std::chrono::high_resolution_clock::now();
             if (!inside) {
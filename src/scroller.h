@@ -7,12 +7,22 @@
 #include <hyprland/src/SharedDefs.hpp>
 #include <hyprland/src/devices/IPointer.hpp>
 
+#include <chrono>
+#include <unordered_map>
+
 #include "enums.h"
+#include "hyprland.h"
+#include "labels.h"
+#include "snapshot.h"
+
+class Window;
 
 class Row;
 
 class ScrollerLayout : public IHyprLayout {
 public:
+    virtual ~ScrollerLayout();
+
     virtual void onEnable();
     virtual void onDisable();
 
@@ -67,7 +77,7 @@ public:
     void pin(WORKSPACEID workspace);
 
     void selection_toggle(WORKSPACEID workspace);
-    void selection_set(PHLWINDOWREF window);
+    void selection_set(PHLWINDOW window);
     void selection_reset();
     void selection_workspace(WORKSPACEID workspace);
     void selection_move(WORKSPACEID workspace, Direction direction = Direction::End);
@@ -84,7 +94,28 @@ public:
 
     void jump();
 
-    void post_event(WORKSPACEID workspace, const std::string &event);
+    void post_event(WORKSPACEID workspace, EventTopic topic);
+
+    // hyprctl scroller stats
+    std::string stats(bool json);
+
+    bool record_start(const std::string &path);
+    void record_stop();
+    // Called by the record timer
+    void record_flush();
+
+    // Schedules writing a snapshot of the layout. Changes made by the user
+    // end restoring the previous one.
+    void snapshot_changed(bool user);
+    // Called by the snapshot timer
+    void snapshot_write();
+    // Called when the event loop is idle after windows were detached, or
+    // rows had their layout deferred
+    void idle_fired();
+    // Called when the event loop is idle after the pointer moved
+    void motion_idle_fired();
+    // Called focus_hover_ms after focusing a window that didn't scroll
+    void hover_timer_fired();
 
     void swipe_begin(IPointer::SSwipeBeginEvent);
     void swipe_update(SCallbackInfo& info, IPointer::SSwipeUpdateEvent);
@@ -97,8 +128,46 @@ public:
 private:
     Row *getRowForWorkspace(WORKSPACEID workspace);
     Row *getRowForWindow(PHLWINDOW window);
+    // Tiled window with this id, or nullptr
+    PHLWINDOW getWindow(WindowID window);
+    // Adds window to the row of its workspace, creating it if needed, and
+    // applies the window rules
+    void addWindow(PHLWINDOW window);
+    // Removes window from row s, marks and trails, and deletes its adapter.
+    // Returns false if it was the last window, and the row was deleted.
+    bool removeWindow(Row *s, WindowID window);
+    void deleteRow(Row *s);
+    // Takes window out of row s without deleting it, and keeps it as
+    // detached until the event loop is idle
+    void detachWindow(Row *s, WindowID window);
+    // Adds window to the row of its new workspace if it is detached.
+    // Returns false if it isn't.
+    bool attachWindow(PHLWINDOW window);
+    // Removes the detached windows for good, if they weren't added back
+    void closeDetached();
+    // With defer_layout, windows added to or removed from row s after this
+    // only change its structure until the event loop is idle
+    void deferLayout(Row *s);
+    // Lays out the deferred rows
+    void flushDeferred();
+    void scheduleIdle();
+    // Records the windows of row s as opened
+    void recordRow(Row *s);
+    // Writes out the recorded operations every second while recording
+    void scheduleRecordFlush();
+    // Registers the input callbacks the options need, and removes the rest
+    void updateInputCallbacks();
+    // Compiles the reloaded options, and lays out again, without animating,
+    // the rows they change
+    void onConfigReloaded();
+    // Starts rasterising the jump label glyphs if their options changed
+    void prepareJumpLabels();
+    // Restores the parts of the snapshot being restored that involve window,
+    // or all of it if window is 0
+    void restoreSnapshot(WindowID window);
     PHLWINDOW getActiveWindow(WORKSPACEID workspace);
 
+    HyprlandAdapter adapter;
     List<Row *> rows;
 
     bool enabled;
@@ -106,6 +175,39 @@ private:
     bool swipe_active;
     Direction swipe_direction;
     bool jumping = false;
+    JumpLabels jump_labels;
+
+    // Snapshot being restored, until all its windows are back, the user
+    // changes the layout or it times out
+    Snapshot restoring;
+    std::unordered_map<WindowID, WindowID> restored;
+    std::chrono::steady_clock::time_point restore_deadline;
+    // Last time focusing the window under the pointer scrolled a row
+    std::chrono::steady_clock::time_point hover_scroll;
+    // The pointer moved in the current event loop dispatch, so focus
+    // changes come from it, with focus_hover_ms
+    bool pointer_motion = false;
+    wl_event_source *motion_idle = nullptr;
+    // Window focused by the pointer that didn't scroll, scrolled by
+    // hover_timer if it still has focus
+    WindowID hover_window = 0;
+    wl_event_source *hover_timer = nullptr;
+    // Last snapshot written
+    std::string snapshot_data;
+    SnapshotWriter snapshot_writer;
+    wl_event_source *snapshot_timer = nullptr;
+    bool snapshot_scheduled = false;
+    wl_event_source *record_timer = nullptr;
+
+    // Hyprland moves a tiled window to another workspace removing it from
+    // the layout and adding it back right away. Windows removed that way
+    // are kept here until the event loop is idle, so a move keeps the
+    // window's sizes and state, and doesn't lay out or focus anything in
+    // between. Closed windows are removed right away.
+    std::vector<Window *> detached;
+    // Workspaces of the rows waiting for their layout, with defer_layout
+    std::vector<WORKSPACEID> deferred;
+    wl_event_source *idle = nullptr;
 };
 
 #endif  // SCROLLER_SCROLLER_H
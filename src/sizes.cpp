@@ -1,13 +1,8 @@
 #include "sizes.h"
+#include "adapter.h"
 
+#include <algorithm>
 #include <sstream>
-#include <hyprland/src/config/ConfigManager.hpp>
-#include <hyprland/src/helpers/Monitor.hpp>
-#include <hyprland/src/plugins/PluginAPI.hpp>
-
-extern HANDLE PHANDLE;
-
-ScrollerSizes scroller_sizes;
 
 StandardSize ScrollerSizes::get_next(const std::vector<StandardSize> &sizes, StandardSize size, int step) const
 {
@@ -22,8 +17,7 @@ StandardSize ScrollerSizes::get_next(const std::vector<StandardSize> &sizes, Sta
         return sizes[0];
     }
     int number = sizes.size();
-    static auto* const *CYCLESIZE_WRAP = (Hyprlang::INT* const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:cyclesize_wrap")->getDataStaticPtr();
-    if (**CYCLESIZE_WRAP)
+    if (cyclesize_wrap)
         current = (number + current + step) % number;
     else {
         current += step;
@@ -35,10 +29,8 @@ StandardSize ScrollerSizes::get_next(const std::vector<StandardSize> &sizes, Sta
     return sizes[current];
 }
 
-StandardSize ScrollerSizes::get_next_window_height(StandardSize size, int step)
+StandardSize ScrollerSizes::get_next_window_height(const std::string &monitor, StandardSize size, int step) const
 {
-    update();
-    const std::string &monitor = g_pCompositor->m_pLastMonitor->szName;
     for (const auto monitor_data : monitors) {
         if (monitor_data.name == monitor)
             return get_next(monitor_data.window_heights, size, step);
@@ -46,10 +38,8 @@ StandardSize ScrollerSizes::get_next_window_height(StandardSize size, int step)
     return get_next(window_heights, size, step);
 }
 
-StandardSize ScrollerSizes::get_next_column_width(StandardSize size, int step)
+StandardSize ScrollerSizes::get_next_column_width(const std::string &monitor, StandardSize size, int step) const
 {
-    update();
-    const std::string &monitor = g_pCompositor->m_pLastMonitor->szName;
     for (const auto monitor_data : monitors) {
         if (monitor_data.name == monitor)
             return get_next(monitor_data.column_widths, size, step);
@@ -63,10 +53,8 @@ StandardSize ScrollerSizes::get_size(const std::vector<StandardSize> &sizes, int
     return sizes[current];
 }
 
-StandardSize ScrollerSizes::get_window_height(int index)
+StandardSize ScrollerSizes::get_window_height(const std::string &monitor, int index) const
 {
-    update();
-    const std::string &monitor = g_pCompositor->m_pLastMonitor->szName;
     for (const auto monitor_data : monitors) {
         if (monitor_data.name == monitor)
             return get_size(monitor_data.window_heights, index);
@@ -74,10 +62,8 @@ StandardSize ScrollerSizes::get_window_height(int index)
     return get_size(window_heights, index);
 }
 
-StandardSize ScrollerSizes::get_column_width(int index)
+StandardSize ScrollerSizes::get_column_width(const std::string &monitor, int index) const
 {
-    update();
-    const std::string &monitor = g_pCompositor->m_pLastMonitor->szName;
     for (const auto monitor_data : monitors) {
         if (monitor_data.name == monitor)
             return get_size(monitor_data.column_widths, index);
@@ -86,47 +72,40 @@ StandardSize ScrollerSizes::get_column_width(int index)
 }
 
 // ScrollerSizes
-Mode ScrollerSizes::get_mode(PHLMONITOR monitor)
+Mode ScrollerSizes::get_mode(const std::string &monitor) const
 {
-    update();
     for (const auto monitor_data : monitors) {
-        if (monitor_data.name == monitor->szName)
+        if (monitor_data.name == monitor)
             return monitor_data.mode;
     }
     return Mode::Row;
 }
 
-StandardSize ScrollerSizes::get_window_default_height(PHLWINDOW window)
+StandardSize ScrollerSizes::get_window_default_height(const WindowAdapter *window) const
 {
     // Check window rules
-    for (auto &r: window->m_vMatchedRules) {
-        if (r->szRule.starts_with("plugin:scroller:windowheight")) {
-            const auto window_height = r->szRule.substr(r->szRule.find_first_of(' ') + 1);
-            return get_size_from_string(window_height, StandardSize::One);
-        }
-    }
-    const auto monitor = window->m_pMonitor.lock();
-    update();
+    const auto rules = window->get_rules("windowheight");
+    if (!rules.empty())
+        return get_size_from_string(rules.front(), StandardSize::One);
+
+    const std::string &monitor = window->get_monitor_name();
     for (const auto monitor_data : monitors) {
-        if (monitor_data.name == monitor->szName)
+        if (monitor_data.name == monitor)
             return monitor_data.window_default_height;
     }
     return window_default_height;
 }
 
-StandardSize ScrollerSizes::get_column_default_width(PHLWINDOW window)
+StandardSize ScrollerSizes::get_column_default_width(const WindowAdapter *window) const
 {
     // Check window rules
-    for (auto &r: window->m_vMatchedRules) {
-        if (r->szRule.starts_with("plugin:scroller:columnwidth")) {
-            const auto column_width = r->szRule.substr(r->szRule.find_first_of(' ') + 1);
-            return get_size_from_string(column_width, StandardSize::OneHalf);
-        }
-    }
-    const auto monitor = window->m_pMonitor.lock();
-    update();
+    const auto rules = window->get_rules("columnwidth");
+    if (!rules.empty())
+        return get_size_from_string(rules.front(), StandardSize::OneHalf);
+
+    const std::string &monitor = window->get_monitor_name();
     for (const auto monitor_data : monitors) {
-        if (monitor_data.name == monitor->szName)
+        if (monitor_data.name == monitor)
             return monitor_data.column_default_width;
     }
     return column_default_width;
@@ -189,22 +168,20 @@ StandardSize ScrollerSizes::get_closest_size(const std::vector<StandardSize> &si
     return sizes[closest];
 }
 
-StandardSize ScrollerSizes::get_window_closest_height(PHLMONITORREF monitor, double fraction, int step)
+StandardSize ScrollerSizes::get_window_closest_height(const std::string &monitor, double fraction, int step) const
 {
-    update();
     for (const auto monitor_data : monitors) {
-        if (monitor_data.name == monitor->szName) {
+        if (monitor_data.name == monitor) {
             return get_closest_size(monitor_data.window_heights, fraction, step);
         }
     }
     return get_closest_size(window_heights, fraction, step);
 }
 
-StandardSize ScrollerSizes::get_column_closest_width(PHLMONITORREF monitor, double fraction, int step)
+StandardSize ScrollerSizes::get_column_closest_width(const std::string &monitor, double fraction, int step) const
 {
-    update();
     for (const auto monitor_data : monitors) {
-        if (monitor_data.name == monitor->szName) {
+        if (monitor_data.name == monitor) {
             return get_closest_size(monitor_data.column_widths, fraction, step);
         }
     }
@@ -248,31 +225,29 @@ void ScrollerSizes::update_sizes(std::vector<StandardSize> &sizes, const std::st
         sizes.push_back(default_size);
 }
 
-void ScrollerSizes::update()
+bool ScrollerSizes::update(const std::string &window_default_height_str, const std::string &column_default_width_str,
+                           const std::string &window_heights_str, const std::string &column_widths_str,
+                           const std::string &monitor_modes_str, bool wrap)
 {
-    static auto const *window_default_height_str = (Hyprlang::STRING const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:window_default_height")->getDataStaticPtr();
-    static auto const *column_default_width_str = (Hyprlang::STRING const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:column_default_width")->getDataStaticPtr();
-    static auto const *window_heights_str = (Hyprlang::STRING const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:window_heights")->getDataStaticPtr();
-    static auto const *column_widths_str = (Hyprlang::STRING const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:column_widths")->getDataStaticPtr();
-    static auto const *monitor_modes_str = (Hyprlang::STRING const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:monitor_options")->getDataStaticPtr();
-
-    if (*window_default_height_str == str_window_default_height &&
-        *column_default_width_str == str_column_default_width &&
-        *window_heights_str == str_window_heights &&
-        *column_widths_str == str_column_widths &&
-        *monitor_modes_str == str_monitors)
-        return;
+    const bool wrap_changed = cyclesize_wrap != wrap;
+    cyclesize_wrap = wrap;
+    if (window_default_height_str == str_window_default_height &&
+        column_default_width_str == str_column_default_width &&
+        window_heights_str == str_window_heights &&
+        column_widths_str == str_column_widths &&
+        monitor_modes_str == str_monitors)
+        return wrap_changed;
 
-    window_default_height = get_size_from_string(*window_default_height_str, StandardSize::One);
-    column_default_width = get_size_from_string(*column_default_width_str, StandardSize::OneHalf);
-    update_sizes(window_heights, *window_heights_str, StandardSize::One);
-    update_sizes(column_widths, *column_widths_str, StandardSize::OneHalf);
+    window_default_height = get_size_from_string(window_default_height_str, StandardSize::One);
+    column_default_width = get_size_from_string(column_default_width_str, StandardSize::OneHalf);
+    update_sizes(window_heights, window_heights_str, StandardSize::One);
+    update_sizes(column_widths, column_widths_str, StandardSize::OneHalf);
  
-    str_window_default_height = *window_default_height_str;
-    str_column_default_width = *column_default_width_str;
-    str_window_heights = *window_heights_str;
-    str_column_widths = *column_widths_str;
-    str_monitors = *monitor_modes_str;
+    str_window_default_height = window_default_height_str;
+    str_column_default_width = column_default_width_str;
+    str_window_heights = window_heights_str;
+    str_column_widths = column_widths_str;
+    str_monitors = monitor_modes_str;
 
     monitors.clear();
 
@@ -345,9 +320,10 @@ void ScrollerSizes::update()
             }
         }
     }
+    return true;
 }
 
-StandardSize ScrollerSizes::get_size_from_string(const std::string &size, StandardSize default_size)
+StandardSize ScrollerSizes::get_size_from_string(const std::string &size, StandardSize default_size) const
 {
     if (size == "one") {
         return StandardSize::One;
@@ -1,54 +1,39 @@
 #ifndef SCROLLER_SIZES_H
 #define SCROLLER_SIZES_H
 
-#include <hyprland/src/Compositor.hpp>
-
+#include <string>
 #include <vector>
 
 #include "enums.h"
 
-enum class StandardSize {
-    OneEighth = 0,
-    OneSixth,
-    OneFourth,
-    OneThird,
-    ThreeEighths,
-    OneHalf,
-    FiveEighths,
-    TwoThirds,
-    ThreeQuarters,
-    FiveSixths,
-    SevenEighths,
-    One,
-    Free
-};
-
-enum class Reorder {
-    Auto,
-    Lazy
-};
+class WindowAdapter;
 
 class ScrollerSizes {
 public:
     ScrollerSizes() {}
     ~ScrollerSizes() {}
 
-    Mode get_mode(PHLMONITOR monitor);
-    StandardSize get_window_default_height(PHLWINDOW window);
-    StandardSize get_column_default_width(PHLWINDOW window);
-    StandardSize get_window_closest_height(PHLMONITORREF monitor, double fraction, int step);
-    StandardSize get_column_closest_width(PHLMONITORREF monitor, double fraction, int step);
-    StandardSize get_next_window_height(StandardSize size, int step);
-    StandardSize get_next_column_width(StandardSize size, int step);
-    StandardSize get_window_height(int index);
-    StandardSize get_column_width(int index);
-    StandardSize get_size_from_string(const std::string &size, StandardSize default_size);
+    // Parses the configuration options, only when they have changed.
+    // Returns true if they have.
+    bool update(const std::string &window_default_height, const std::string &column_default_width,
+                const std::string &window_heights, const std::string &column_widths,
+                const std::string &monitor_options, bool cyclesize_wrap);
+
+    Mode get_mode(const std::string &monitor) const;
+    StandardSize get_window_default_height(const WindowAdapter *window) const;
+    StandardSize get_column_default_width(const WindowAdapter *window) const;
+    StandardSize get_window_closest_height(const std::string &monitor, double fraction, int step) const;
+    StandardSize get_column_closest_width(const std::string &monitor, double fraction, int step) const;
+    StandardSize get_next_window_height(const std::string &monitor, StandardSize size, int step) const;
+    StandardSize get_next_column_width(const std::string &monitor, StandardSize size, int step) const;
+    StandardSize get_window_height(const std::string &monitor, int index) const;
+    StandardSize get_column_width(const std::string &monitor, int index) const;
+    StandardSize get_size_from_string(const std::string &size, StandardSize default_size) const;
 
 private:
     StandardSize get_next(const std::vector<StandardSize> &sizes, StandardSize size, int step) const;
     StandardSize get_size(const std::vector<StandardSize> &sizes, int index) const;
     StandardSize get_closest_size(const std::vector<StandardSize> &sizes, double fraction, int step) const;
-    void update();
     void update_sizes(std::vector<StandardSize> &sizes, const std::string &option, StandardSize default_size);
     void trim(std::string &str);
 
@@ -57,6 +42,7 @@ private:
     std::string str_monitors;
     std::string str_window_heights;
     std::string str_column_widths;
+    bool cyclesize_wrap = true;
 
     // Configuration globals
     StandardSize window_default_height;
@@ -0,0 +1,335 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "snapshot.h"
+
+static const char MAGIC[4] = { 'H', 'S', 'S', 'N' };
+
+namespace {
+    class Writer {
+    public:
+        Writer(std::string &data) : data(data) {}
+
+        template <typename T>
+        void put(T value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+        void put(const std::string &str) {
+            put(static_cast<uint32_t>(str.size()));
+            data.append(str);
+        }
+        template <typename E>
+        void put_enum(E value) {
+            put(static_cast<uint8_t>(value));
+        }
+
+    private:
+        std::string &data;
+    };
+
+    // Every read checks the bounds, and the first failure makes the rest
+    // fail too, so callers only check ok() at the end
+    class Reader {
+    public:
+        Reader(std::string_view data) : data(data), failed(false) {}
+
+        bool ok() const { return !failed; }
+        bool at_end() const { return data.empty(); }
+
+        template <typename T>
+        T get() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value{};
+            if (failed || data.size() < sizeof(T)) {
+                failed = true;
+                return value;
+            }
+            std::memcpy(&value, data.data(), sizeof(T));
+            data.remove_prefix(sizeof(T));
+            return value;
+        }
+        std::string get_string() {
+            const uint32_t size = get<uint32_t>();
+            if (failed || data.size() < size) {
+                failed = true;
+                return {};
+            }
+            std::string str(data.substr(0, size));
+            data.remove_prefix(size);
+            return str;
+        }
+        template <typename E>
+        E get_enum(E last) {
+            const uint8_t value = get<uint8_t>();
+            if (value > static_cast<uint8_t>(last))
+                failed = true;
+            return static_cast<E>(value);
+        }
+        // Element count of a list, which can't be larger than the bytes left
+        uint32_t get_count() {
+            const uint32_t count = get<uint32_t>();
+            if (count > data.size())
+                failed = true;
+            return failed ? 0 : count;
+        }
+
+    private:
+        std::string_view data;
+        bool failed;
+    };
+}
+
+void Snapshot::clear()
+{
+    rows.clear();
+    marks.clear();
+    trails.clear();
+    active_trail = -1;
+}
+
+void Snapshot::serialize(std::string &data) const
+{
+    data.clear();
+    Writer out(data);
+    data.append(MAGIC, sizeof(MAGIC));
+    out.put(VERSION);
+    out.put(static_cast<uint32_t>(rows.size()));
+    for (const auto &row : rows) {
+        out.put(static_cast<int64_t>(row.workspace));
+        out.put(row.workspace_name);
+        out.put_enum(row.mode);
+        out.put(row.active);
+        out.put(row.pinned);
+        out.put(static_cast<uint32_t>(row.columns.size()));
+        for (const auto &column : row.columns) {
+            out.put_enum(column.width);
+            out.put(column.w);
+            out.put(column.name);
+            out.put(column.active);
+            out.put(static_cast<uint32_t>(column.windows.size()));
+            for (const auto &window : column.windows) {
+                out.put(static_cast<uint64_t>(window.key.id));
+                out.put(window.key.app_class);
+                out.put(window.key.title);
+                out.put_enum(window.height);
+                out.put_enum(window.width);
+                out.put(window.h);
+            }
+        }
+    }
+    out.put(static_cast<uint32_t>(marks.size()));
+    for (const auto &mark : marks) {
+        out.put(mark.name);
+        out.put(static_cast<uint64_t>(mark.window));
+    }
+    out.put(active_trail);
+    out.put(static_cast<uint32_t>(trails.size()));
+    for (const auto &trail : trails) {
+        out.put(static_cast<uint64_t>(trail.active));
+        out.put(static_cast<uint32_t>(trail.windows.size()));
+        for (auto window : trail.windows)
+            out.put(static_cast<uint64_t>(window));
+    }
+}
+
+bool Snapshot::deserialize(std::string_view data)
+{
+    clear();
+    if (data.size() < sizeof(MAGIC) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0)
+        return false;
+    Reader in(data.substr(sizeof(MAGIC)));
+    if (in.get<uint32_t>() != VERSION)
+        return false;
+
+    rows.resize(in.get_count());
+    for (auto &row : rows) {
+        row.workspace = in.get<int64_t>();
+        row.workspace_name = in.get_string();
+        row.mode = in.get_enum(Mode::Column);
+        row.active = in.get<int32_t>();
+        row.pinned = in.get<int32_t>();
+        row.columns.resize(in.get_count());
+        for (auto &column : row.columns) {
+            column.width = in.get_enum(StandardSize::Free);
+            column.w = in.get<double>();
+            column.name = in.get_string();
+            column.active = in.get<uint32_t>();
+            column.windows.resize(in.get_count());
+            for (auto &window : column.windows) {
+                window.key.id = in.get<uint64_t>();
+                window.key.app_class = in.get_string();
+                window.key.title = in.get_string();
+                window.height = in.get_enum(StandardSize::Free);
+                window.width = in.get_enum(StandardSize::Free);
+                window.h = in.get<double>();
+            }
+        }
+    }
+    marks.resize(in.get_count());
+    for (auto &mark : marks) {
+        mark.name = in.get_string();
+        mark.window = in.get<uint64_t>();
+    }
+    active_trail = in.get<int32_t>();
+    trails.resize(in.get_count());
+    for (auto &trail : trails) {
+        trail.active = in.get<uint64_t>();
+        trail.windows.resize(in.get_count());
+        for (auto &window : trail.windows)
+            window = in.get<uint64_t>();
+    }
+
+    if (!in.ok() || !in.at_end()) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void Snapshot::match(const std::vector<WindowKey> &live, std::unordered_map<WindowID, WindowID> &ids,
+                     const SnapshotRow *row) const
+{
+    std::unordered_map<WindowID, size_t> by_id;
+    std::unordered_multimap<std::string, size_t> by_title, by_class;
+    std::vector<bool> used(live.size(), false);
+    for (size_t i = 0; i < live.size(); ++i) {
+        by_id[live[i].id] = i;
+        by_title.emplace(live[i].app_class + '\n' + live[i].title, i);
+        by_class.emplace(live[i].app_class, i);
+    }
+    for (const auto &id : ids) {
+        auto i = by_id.find(id.second);
+        if (i != by_id.end())
+            used[i->second] = true;
+    }
+
+    // Takes the first unused live window in range
+    auto take = [&](auto range, WindowID id) {
+        for (auto i = range.first; i != range.second; ++i) {
+            if (!used[i->second]) {
+                used[i->second] = true;
+                ids[id] = live[i->second].id;
+                return;
+            }
+        }
+    };
+    auto each_window = [&](auto pass) {
+        for (const auto &saved : rows) {
+            if (row != nullptr && &saved != row)
+                continue;
+            for (const auto &column : saved.columns) {
+                for (const auto &window : column.windows) {
+                    if (!ids.contains(window.key.id))
+                        pass(window.key);
+                }
+            }
+        }
+    };
+    each_window([&](const WindowKey &key) {
+        auto i = by_id.find(key.id);
+        if (i != by_id.end() && !used[i->second] && live[i->second].app_class == key.app_class) {
+            used[i->second] = true;
+            ids[key.id] = key.id;
+        }
+    });
+    each_window([&](const WindowKey &key) {
+        take(by_title.equal_range(key.app_class + '\n' + key.title), key.id);
+    });
+    each_window([&](const WindowKey &key) {
+        take(by_class.equal_range(key.app_class), key.id);
+    });
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    if (!thread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_one();
+    thread.join();
+}
+
+void SnapshotWriter::write(const std::string &path, std::string &&data)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->path = path;
+        this->data = std::move(data);
+        pending = true;
+    }
+    if (!thread.joinable())
+        thread = std::thread(&SnapshotWriter::run, this);
+    cv.notify_one();
+}
+
+// Creates the missing directories of path, private to the user
+static bool make_parents(const std::string &path)
+{
+    for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        const std::string dir = path.substr(0, slash);
+        if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST)
+            return false;
+    }
+    return true;
+}
+
+static bool write_all(int fd, const std::string &data)
+{
+    for (size_t done = 0; done < data.size();) {
+        const ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        done += n;
+    }
+    return true;
+}
+
+void SnapshotWriter::run()
+{
+    std::string path, data;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return pending || stopping; });
+            if (!pending)
+                return;
+            path.swap(this->path);
+            data.swap(this->data);
+            pending = false;
+        }
+        // Write a new temporary file and rename it, so readers never see a
+        // partial snapshot
+        if (!make_parents(path))
+            continue;
+        std::string tmp = path + ".XXXXXX";
+        const int fd = mkstemp(tmp.data());
+        if (fd < 0)
+            continue;
+        const bool written = write_all(fd, data) && fsync(fd) == 0;
+        if (close(fd) == 0 && written && std::rename(tmp.c_str(), path.c_str()) == 0)
+            continue;
+        unlink(tmp.c_str());
+    }
+}
+
+bool read_snapshot(const std::string &path, Snapshot &snapshot)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+    const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return snapshot.deserialize(data);
+}
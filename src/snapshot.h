@@ -0,0 +1,123 @@
+#ifndef SCROLLER_SNAPSHOT_H
+#define SCROLLER_SNAPSHOT_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "adapter.h"
+
+// Layout snapshot, so an arrangement survives reloading the plugin or
+// restarting the compositor: rows, the order, sizes and names of their
+// columns, the pinned and active columns, marks and trails.
+//
+// Window ids are addresses, which only survive a plugin reload, so windows
+// also carry their class and title. Restoring maps the snapshot windows to
+// live ones with match(), and rows, marks and trails take that map.
+
+// How a window is recognized when the layout is restored
+struct WindowKey {
+    WindowID id;
+    std::string app_class;
+    std::string title;
+};
+
+struct SnapshotWindow {
+    WindowKey key;
+    StandardSize height;
+    StandardSize width;
+    // Height of the window's box, for StandardSize::Free
+    double h;
+};
+
+struct SnapshotColumn {
+    StandardSize width;
+    // Width of the column, for StandardSize::Free
+    double w;
+    std::string name;
+    uint32_t active;
+    std::vector<SnapshotWindow> windows;
+};
+
+struct SnapshotRow {
+    WorkspaceID workspace;
+    std::string workspace_name;
+    Mode mode;
+    // Column indices, -1 if none
+    int32_t active;
+    int32_t pinned;
+    std::vector<SnapshotColumn> columns;
+};
+
+struct SnapshotMark {
+    std::string name;
+    WindowID window;
+};
+
+struct SnapshotTrail {
+    WindowID active;
+    std::vector<WindowID> windows;
+};
+
+class Snapshot {
+public:
+    // Bumped on every change of the binary format. Snapshots of other
+    // versions are ignored.
+    static constexpr uint32_t VERSION = 1;
+
+    Snapshot() : active_trail(-1) {}
+
+    bool empty() const { return rows.empty(); }
+    void clear();
+
+    // Native byte order: snapshots don't leave the machine that wrote them
+    void serialize(std::string &data) const;
+    // Returns false, and leaves the snapshot empty, if data is not a
+    // snapshot of this version
+    bool deserialize(std::string_view data);
+
+    // Maps the windows of the snapshot to live windows, by address and class
+    // (the plugin was reloaded), then class and title, then class only, for
+    // windows whose title changed, in the snapshot's order. Each live window
+    // is used once. Live windows already in ids are not matched again. If
+    // row is not null, only its windows are matched.
+    void match(const std::vector<WindowKey> &live, std::unordered_map<WindowID, WindowID> &ids,
+               const SnapshotRow *row = nullptr) const;
+
+    std::vector<SnapshotRow> rows;
+    std::vector<SnapshotMark> marks;
+    std::vector<SnapshotTrail> trails;
+    int32_t active_trail;
+};
+
+// Writes snapshots to disk from a background thread, replacing the file
+// atomically. Only the latest pending snapshot is written.
+class SnapshotWriter {
+public:
+    SnapshotWriter() : stopping(false), pending(false) {}
+    // Finishes writing the pending snapshot
+    ~SnapshotWriter();
+
+    void write(const std::string &path, std::string &&data);
+
+private:
+    void run();
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping;
+    bool pending;
+    std::string path;
+    std::string data;
+};
+
+// Reads the snapshot at path, returns false if there is none or it is invalid
+bool read_snapshot(const std::string &path, Snapshot &snapshot);
+
+#endif // SCROLLER_SNAPSHOT_H
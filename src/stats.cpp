@@ -0,0 +1,119 @@
+#include <format>
+
+#include "stats.h"
+
+LayoutStats layout_stats;
+
+static const char *trigger_name(StatsTrigger trigger)
+{
+    switch (trigger) {
+    case StatsTrigger::None:
+        return "other";
+    case StatsTrigger::Dispatcher:
+        return "dispatcher";
+    case StatsTrigger::FocusChange:
+        return "focuschange";
+    case StatsTrigger::RecalculateMonitor:
+        return "recalculatemonitor";
+    case StatsTrigger::RecalculateWindow:
+        return "recalculatewindow";
+    case StatsTrigger::Gesture:
+        return "gesture";
+    case StatsTrigger::Window:
+        return "window";
+    case StatsTrigger::Config:
+        return "config";
+    case StatsTrigger::Deferred:
+        return "deferred";
+    default:
+        return "unknown";
+    }
+}
+
+StructureStats &StructureStats::operator+=(const StructureStats &other)
+{
+    rows += other.rows;
+    columns += other.columns;
+    windows += other.windows;
+    list_nodes += other.list_nodes;
+    bytes += other.bytes;
+    decorations += other.decorations;
+    decoration_bytes += other.decoration_bytes;
+    return *this;
+}
+
+// Milliseconds, or "-" if it hasn't happened yet
+static std::string startup_ms(int64_t us, bool json)
+{
+    if (us < 0)
+        return json ? "null" : "-";
+    return std::format("{:.3f}", us / 1000.0);
+}
+
+static std::string structure_text(const std::string &name, const StructureStats &s)
+{
+    return std::format("{:<12} {:>6} {:>8} {:>8} {:>10} {:>10} {:>12} {:>10}\n", name, s.rows, s.columns,
+                       s.windows, s.list_nodes, s.bytes, s.decorations, s.decoration_bytes);
+}
+
+static std::string structure_json(const StructureStats &s)
+{
+    return std::format("\"rows\": {}, \"columns\": {}, \"windows\": {}, \"list_nodes\": {}, \"bytes\": {}, "
+                       "\"decorations\": {}, \"decoration_bytes\": {}", s.rows, s.columns, s.windows,
+                       s.list_nodes, s.bytes, s.decorations, s.decoration_bytes);
+}
+
+std::string LayoutStats::report(const std::vector<std::pair<WorkspaceID, StructureStats>> &workspaces, bool json) const
+{
+    StructureStats total;
+    for (const auto &workspace : workspaces) {
+        total += workspace.second;
+    }
+    Counters all;
+    for (const auto &c : counters) {
+        all.invocations += c.invocations;
+        all.relayouts += c.relayouts;
+        all.configures += c.configures;
+        all.overview_toggles += c.overview_toggles;
+    }
+
+    std::string result;
+    if (json) {
+        result = "{\n  \"workspaces\": [";
+        for (size_t i = 0; i < workspaces.size(); ++i) {
+            result += std::format("{}\n    {{ \"id\": {}, {} }}", i > 0 ? "," : "", workspaces[i].first,
+                                  structure_json(workspaces[i].second));
+        }
+        result += std::format("\n  ],\n  \"total\": {{ {} }},\n  \"triggers\": {{", structure_json(total));
+        for (int t = 0; t < (int)StatsTrigger::Count; ++t) {
+            const Counters &c = counters[t];
+            result += std::format("{}\n    \"{}\": {{ \"invocations\": {}, \"relayouts\": {}, \"configures\": {}, "
+                                  "\"overview_toggles\": {} }}", t > 0 ? "," : "", trigger_name((StatsTrigger)t),
+                                  c.invocations, c.relayouts, c.configures, c.overview_toggles);
+        }
+        result += std::format("\n  }},\n  \"startup\": {{ \"init_ms\": {}, \"first_layout_ms\": {}, \"enable_ms\": {} }}"
+                              "\n}}\n", startup_ms(startup.init_us, true), startup_ms(startup.first_layout_us, true),
+                              startup_ms(startup.enable_us, true));
+        return result;
+    }
+
+    result = std::format("{:<12} {:>6} {:>8} {:>8} {:>10} {:>10} {:>12} {:>10}\n", "workspace", "rows", "columns",
+                         "windows", "list nodes", "bytes", "decorations", "deco bytes");
+    for (const auto &workspace : workspaces) {
+        result += structure_text(std::to_string(workspace.first), workspace.second);
+    }
+    result += structure_text("total", total);
+    result += std::format("\n{:<20} {:>12} {:>12} {:>12} {:>12}\n", "trigger", "invocations", "relayouts",
+                          "configures", "overviews");
+    for (int t = 0; t < (int)StatsTrigger::Count; ++t) {
+        const Counters &c = counters[t];
+        result += std::format("{:<20} {:>12} {:>12} {:>12} {:>12}\n", trigger_name((StatsTrigger)t),
+                              c.invocations, c.relayouts, c.configures, c.overview_toggles);
+    }
+    result += std::format("{:<20} {:>12} {:>12} {:>12} {:>12}\n", "total", all.invocations, all.relayouts,
+                          all.configures, all.overview_toggles);
+    result += std::format("\nstartup: init {} ms, first layout {} ms (enable {} ms)\n",
+                          startup_ms(startup.init_us, false), startup_ms(startup.first_layout_us, false),
+                          startup_ms(startup.enable_us, false));
+    return result;
+}
@@ -0,0 +1,116 @@
+#ifndef SCROLLER_STATS_H
+#define SCROLLER_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "adapter.h"
+
+// What started the layout work being counted
+enum class StatsTrigger : uint8_t {
+    None,               // not in a StatsScope (startup...)
+    Dispatcher,
+    FocusChange,
+    RecalculateMonitor,
+    RecalculateWindow,
+    Gesture,
+    Window,             // window creation, removal, fullscreen and resize requests
+    Config,             // configuration reloads
+    Deferred,           // deferred layouts and focus, run when the event loop is idle
+    Count
+};
+
+// Objects held by the layout for a workspace, and memory used by them
+struct StructureStats {
+    size_t rows = 0;
+    size_t columns = 0;
+    size_t windows = 0;
+    size_t list_nodes = 0;
+    size_t bytes = 0;               // Row, Column, Window, window adapters and list nodes
+    size_t decorations = 0;
+    size_t decoration_bytes = 0;
+
+    StructureStats &operator+=(const StructureStats &other);
+};
+
+// Cumulative layout work, broken down by trigger. Counting is a couple of
+// increments, so it is always on.
+class LayoutStats {
+public:
+    struct Counters {
+        uint64_t invocations = 0;
+        uint64_t relayouts = 0;         // Row::recalculate_row_geometry()
+        uint64_t configures = 0;        // new window sizes sent to clients
+        uint64_t overview_toggles = 0;
+    };
+
+    // Plugin load cost: PLUGIN_INIT, and from its start to the first layout
+    // of the existing windows (onEnable) when PLUGIN_INIT enabled the layout
+    struct Startup {
+        std::chrono::steady_clock::time_point start;
+        int64_t init_us = -1;
+        int64_t first_layout_us = -1;   // -1 if the layout was enabled later
+        int64_t enable_us = -1;         // the first onEnable on its own
+    };
+
+    LayoutStats() : trigger(StatsTrigger::None) {}
+
+    void init_begin() { startup.start = std::chrono::steady_clock::now(); }
+    void init_end() { startup.init_us = since(startup.start); }
+    // Only the first layout counts. If it happens after PLUGIN_INIT, the time
+    // from init would include whatever the compositor did in between, so
+    // only the layout itself is reported.
+    void first_layout(std::chrono::steady_clock::time_point enable_start) {
+        if (startup.enable_us >= 0)
+            return;
+        if (startup.init_us < 0)
+            startup.first_layout_us = since(startup.start);
+        startup.enable_us = since(enable_start);
+    }
+    const Startup &get_startup() const { return startup; }
+
+    void relayout() { counters[(int)trigger].relayouts++; }
+    void configure() { counters[(int)trigger].configures++; }
+    void overview_toggle() { counters[(int)trigger].overview_toggles++; }
+    const Counters &get_counters(StatsTrigger t) const { return counters[(int)t]; }
+
+    // Report for "hyprctl scroller stats", as text or JSON
+    std::string report(const std::vector<std::pair<WorkspaceID, StructureStats>> &workspaces, bool json) const;
+
+private:
+    friend class StatsScope;
+
+    static int64_t since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    StatsTrigger trigger;
+    Startup startup;
+    Counters counters[(int)StatsTrigger::Count];
+};
+
+extern LayoutStats layout_stats;
+
+// Counts an invocation of trigger, and attributes the layout work done in
+// its lifetime to it. Nested scopes (a dispatcher causing a focus change)
+// count their invocation, but the work goes to the outermost one.
+class StatsScope {
+public:
+    StatsScope(StatsTrigger trigger) : previous(layout_stats.trigger) {
+        layout_stats.counters[(int)trigger].invocations++;
+        if (previous == StatsTrigger::None)
+            layout_stats.trigger = trigger;
+    }
+    ~StatsScope() {
+        layout_stats.trigger = previous;
+    }
+
+private:
+    StatsTrigger previous;
+};
+
+#endif // SCROLLER_STATS_H
@@ -0,0 +1,76 @@
+#include <chrono>
+#include <fstream>
+
+#include "trace.h"
+
+FlightRecorder flight_recorder;
+
+static const char *category_name(TraceCategory category)
+{
+    switch (category) {
+    case TraceCategory::Dispatcher:
+        return "dispatcher";
+    case TraceCategory::Layout:
+        return "layout";
+    case TraceCategory::Window:
+        return "window";
+    default:
+        return "unknown";
+    }
+}
+
+void FlightRecorder::record(char phase, TraceCategory category, const char *name, int64_t workspace, uint64_t window)
+{
+    const uint64_t sequence = head.fetch_add(1, std::memory_order_relaxed);
+    Event &event = events[sequence & (CAPACITY - 1)];
+    // Mark the slot as being written, so a concurrent dump skips it
+    event.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    event.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    event.name = name;
+    event.workspace = workspace;
+    event.window = window;
+    event.category = category;
+    event.phase = phase;
+    event.sequence.store(sequence + 1, std::memory_order_release);
+}
+
+bool FlightRecorder::dump(const std::string &path) const
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    const uint64_t last = head.load(std::memory_order_acquire);
+    const uint64_t first = last > CAPACITY ? last - CAPACITY : 0;
+    bool separator = false;
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (uint64_t sequence = first; sequence < last; ++sequence) {
+        const Event &event = events[sequence & (CAPACITY - 1)];
+        if (event.sequence.load(std::memory_order_acquire) != sequence + 1)
+            continue;
+        const uint64_t timestamp = event.timestamp;
+        const char *name = event.name;
+        const int64_t workspace = event.workspace;
+        const uint64_t window = event.window;
+        const TraceCategory category = event.category;
+        const char phase = event.phase;
+        // Overwritten while copying
+        if (event.sequence.load(std::memory_order_acquire) != sequence + 1)
+            continue;
+        if (separator)
+            file << ",";
+        separator = true;
+        file << "\n{\"name\":\"" << name << "\",\"cat\":\"" << category_name(category) <<
+                "\",\"ph\":\"" << phase << "\",\"ts\":" << timestamp / 1000 << "." <<
+                (timestamp % 1000) / 100 << ",\"pid\":1,\"tid\":1";
+        if (phase == 'i')
+            file << ",\"s\":\"t\"";
+        file << ",\"args\":{\"workspace\":" << workspace << ",\"window\":\"0x" << std::hex <<
+                window << std::dec << "\"}}";
+    }
+    file << "\n]}\n";
+    file.close();
+    return !file.fail();
+}
@@ -0,0 +1,77 @@
+#ifndef SCROLLER_TRACE_H
+#define SCROLLER_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+enum class TraceCategory : uint8_t {
+    Dispatcher,
+    Layout,
+    Window
+};
+
+// Always-on flight recorder. It keeps the last CAPACITY trace events in a
+// fixed-size ring buffer, so recording never allocates, and can be dumped in
+// Chrome's trace-event JSON format (chrome://tracing, Perfetto) when
+// something feels slow.
+class FlightRecorder {
+public:
+    FlightRecorder() : head(0) {}
+
+    // Names must be string literals (or live for the whole session), only
+    // their pointer is stored.
+    void begin(TraceCategory category, const char *name, int64_t workspace = -1, uint64_t window = 0) {
+        record('B', category, name, workspace, window);
+    }
+    void end(TraceCategory category, const char *name, int64_t workspace = -1, uint64_t window = 0) {
+        record('E', category, name, workspace, window);
+    }
+    void instant(TraceCategory category, const char *name, int64_t workspace = -1, uint64_t window = 0) {
+        record('i', category, name, workspace, window);
+    }
+
+    bool dump(const std::string &path) const;
+
+private:
+    struct Event {
+        // Sequence number + 1 of the event stored in the slot, 0 if empty or
+        // being written.
+        std::atomic<uint64_t> sequence;
+        uint64_t timestamp;
+        const char *name;
+        int64_t workspace;
+        uint64_t window;
+        TraceCategory category;
+        char phase;
+    };
+
+    void record(char phase, TraceCategory category, const char *name, int64_t workspace, uint64_t window);
+
+    static constexpr uint64_t CAPACITY = 1 << 16;
+    std::atomic<uint64_t> head;
+    Event events[CAPACITY];
+};
+
+extern FlightRecorder flight_recorder;
+
+// Records a begin event on construction and the matching end event when it
+// goes out of scope.
+class TraceScope {
+public:
+    TraceScope(TraceCategory category, const char *name, int64_t workspace = -1, uint64_t window = 0)
+        : category(category), name(name), workspace(workspace), window(window) {
+        flight_recorder.begin(category, name, workspace, window);
+    }
+    ~TraceScope() {
+        flight_recorder.end(category, name, workspace, window);
+    }
+
+private:
+    TraceCategory category;
+    const char *name;
+    int64_t workspace;
+    uint64_t window;
+};
+
+#endif // SCROLLER_TRACE_H
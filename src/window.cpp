@@ -1,19 +1,11 @@
-#include <hyprland/src/config/ConfigManager.hpp>
-#include <hyprland/src/plugins/PluginAPI.hpp>
-
 #include "window.h"
 
-extern HANDLE PHANDLE;
-extern ScrollerSizes scroller_sizes;
-
-Window::Window(PHLWINDOW window, double maxy, double box_h, StandardSize width) : window(window), selected(false), width(width)
+Window::Window(WindowAdapter *window, StandardSize height, double maxy, double box_h, StandardSize width)
+    : window(window), id(window->get_id()), selected(false), width(width),
+      geom_w(window->get_size().x)
 {
-    StandardSize h = scroller_sizes.get_window_default_height(window);
-    window->m_vPosition.y = maxy;
-    update_height(h, box_h);
-    auto deco = makeUnique<SelectionBorders>(this);
-    decoration = deco.get();
-    HyprlandAPI::addWindowDecoration(PHANDLE, window, std::move(deco));
+    window->set_position(Vector2D(window->get_position().x, maxy));
+    update_height(height, box_h);
 }
 
 void Window::update_height(StandardSize h, double max)
@@ -61,10 +53,44 @@ void Window::update_height(StandardSize h, double max)
     }
 }
 
-CGradientValueData Window::get_border_color() const
+int LayoutPlan::depth = 0;
+std::vector<std::pair<Window *, bool>> LayoutPlan::pending;
+
+bool LayoutPlan::add(Window *window, bool animate)
 {
-    static auto *const *SELECTEDCOL = (Hyprlang::INT *const *)HyprlandAPI::getConfigValue(PHANDLE, "plugin:scroller:col.selection_border")->getDataStaticPtr();
-    static CHyprColor selected_col = **SELECTEDCOL;
-    return selected ? selected_col : window->m_cRealBorderColor;
+    if (depth == 0)
+        return false;
+    if (window->plan_index >= 0) {
+        pending[window->plan_index].second = animate;
+    } else {
+        window->plan_index = static_cast<int>(pending.size());
+        pending.emplace_back(window, animate);
+    }
+    return true;
 }
 
+void LayoutPlan::remove(Window *window)
+{
+    pending[window->plan_index].first = nullptr;
+    window->plan_index = -1;
+}
+
+void LayoutPlan::apply()
+{
+    // The plan is closed, so windows committed while applying it, if a
+    // commit ever calls back into the layout, commit right away
+    std::vector<std::pair<Window *, bool>> windows;
+    windows.swap(pending);
+    for (auto &window : windows) {
+        if (window.first != nullptr)
+            window.first->plan_index = -1;
+    }
+    for (auto &window : windows) {
+        if (window.first != nullptr)
+            window.first->apply(window.second);
+    }
+    // Keep the storage for the next plan
+    windows.clear();
+    if (pending.empty())
+        pending.swap(windows);
+}
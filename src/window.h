@@ -1,29 +1,65 @@
 #ifndef SCROLLER_WINDOW_H
 #define SCROLLER_WINDOW_H
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "common.h"
-#include "sizes.h"
-#include "decorations.h"
+#include "adapter.h"
+#include "stats.h"
+
+class Window;
+
+// Two-phase layout. While a plan is open, laying out only computes the new
+// geometry of the windows, and notes which ones need a commit. Closing the
+// outermost plan applies it: every noted window commits once, with its final
+// geometry, and the adapters skip the ones that didn't change. Plans nest,
+// so a relayout of several rows applies once at the end.
+class LayoutPlan {
+public:
+    LayoutPlan() { depth++; }
+    ~LayoutPlan() {
+        if (--depth == 0)
+            apply();
+    }
+
+    // Notes window needs a commit. Returns false if no plan is open.
+    static bool add(Window *window, bool animate);
+    // Forgets a window that is deleted before the plan is applied
+    static void remove(Window *window);
+
+private:
+    static void apply();
+
+    static int depth;
+    // Windows to commit, with their animate flag from the last commit
+    static std::vector<std::pair<Window *, bool>> pending;
+};
 
 class Window {
 public:
-    Window(PHLWINDOW window, double maxy, double box_h, StandardSize width);
+    Window(WindowAdapter *window, StandardSize height, double maxy, double box_h, StandardSize width);
     ~Window() {
-        window->removeWindowDeco(decoration);
+        if (plan_index >= 0)
+            LayoutPlan::remove(this);
     }
-    PHLWINDOW get_window() { return window.lock(); }
+    WindowAdapter *get_window() const { return window; }
+    WindowID get_id() const { return id; }
     double get_geom_h() const { return box_h; }
+    // Height out of overview mode
+    double get_geom_h(bool overview) const { return overview ? mem_ov.box_h : box_h; }
     void set_geom_h(double geom_h) { box_h = geom_h; }
 
     void set_geom_x(double x, const Vector2D &gap_x) {
-        SBoxExtents reserved_area = window->getFullWindowReservedArea();
-        Vector2D topL = reserved_area.topLeft, botR = reserved_area.bottomRight;
-        window->m_vPosition.x = x + topL.x + gap_x.x;
+        Extents reserved_area = window->get_reserved_area();
+        Vector2D topL = reserved_area.top_left;
+        window->set_position(Vector2D(x + topL.x + gap_x.x, window->get_position().y));
     }
     double get_geom_y(double gap0) const {
-        SBoxExtents reserved_area = window->getFullWindowReservedArea();
-        Vector2D topL = reserved_area.topLeft, botR = reserved_area.bottomRight;
-        return window->m_vPosition.y - topL.y - gap0;
+        Extents reserved_area = window->get_reserved_area();
+        Vector2D topL = reserved_area.top_left;
+        return window->get_position().y - topL.y - gap0;
     }
     void push_fullscreen_geom() {
         push_geom(mem_fs);
@@ -47,86 +83,79 @@ public:
     void set_width(StandardSize w) { width = w; }
     StandardSize get_width() const { return width; }
     void set_geom_w(double geomw, const Vector2D &gap_x) {
-        SBoxExtents reserved_area = window->getFullWindowReservedArea();
-        Vector2D topL = reserved_area.topLeft, botR = reserved_area.bottomRight;
+        Extents reserved_area = window->get_reserved_area();
+        Vector2D topL = reserved_area.top_left, botR = reserved_area.bottom_right;
         geom_w = geomw - topL.x - botR.x - gap_x.x - gap_x.y;
     }
     double get_geom_w(const Vector2D &gap_x) const {
-        SBoxExtents reserved_area = window->getFullWindowReservedArea();
-        Vector2D topL = reserved_area.topLeft, botR = reserved_area.bottomRight;
+        Extents reserved_area = window->get_reserved_area();
+        Vector2D topL = reserved_area.top_left, botR = reserved_area.bottom_right;
         return geom_w + topL.x + botR.x + gap_x.x + gap_x.y;
     }
 
     void set_geometry(const Box &box) {
-        window->m_vPosition = Vector2D(box.x, box.y);
-        window->m_vSize = Vector2D(box.w, box.h);
-        *window->m_vRealPosition = window->m_vPosition;
-        *window->m_vRealSize = window->m_vSize;
-        window->sendWindowSize();
+        window->set_position(Vector2D(box.x, box.y));
+        window->set_size(Vector2D(box.w, box.h));
+        commit(true);
     }
-    bool is_window(PHLWINDOW w) const {
-        return window == w;
+    bool is_window(WindowID w) const {
+        return id == w;
     }
-    
-    eFullscreenMode fullscreen_state() const {
-        return window->m_sFullscreenState.internal;
+
+    FullscreenMode fullscreen_state() const {
+        return window->get_fullscreen_mode();
     }
 
     void scale(const Vector2D &bmin, const Vector2D &start, double scale, double gap0, double gap1) {
         set_geom_h(get_geom_h() * scale);
-        SBoxExtents reserved_area = window->getFullWindowReservedArea();
-        window->m_vPosition = start + reserved_area.topLeft + (window->m_vPosition - reserved_area.topLeft - bmin) * scale;
-        window->m_vPosition.y += gap0;
-        window->m_vSize.x *= scale;
-        window->m_vSize.y = (window->m_vSize.y + reserved_area.topLeft.y + reserved_area.bottomRight.y + gap0 + gap1) * scale - gap0 - gap1 - reserved_area.topLeft.y - reserved_area.bottomRight.y;
-        window->m_vSize = Vector2D(std::max(window->m_vSize.x, 1.0), std::max(window->m_vSize.y, 1.0));
-        *window->m_vRealSize = window->m_vSize;
-        *window->m_vRealPosition = window->m_vPosition;
-        window->sendWindowSize();
+        Extents reserved_area = window->get_reserved_area();
+        Vector2D position = start + reserved_area.top_left + (window->get_position() - reserved_area.top_left - bmin) * scale;
+        position.y += gap0;
+        Vector2D size = window->get_size();
+        size.x *= scale;
+        size.y = (size.y + reserved_area.top_left.y + reserved_area.bottom_right.y + gap0 + gap1) * scale - gap0 - gap1 - reserved_area.top_left.y - reserved_area.bottom_right.y;
+        window->set_position(position);
+        window->set_size(Vector2D(std::max(size.x, 1.0), std::max(size.y, 1.0)));
+        commit(true);
     }
 
     void move_to_bottom(double x, const Box &max, const Vector2D &gap_x, double gap) {
-        SBoxExtents reserved_area = window->getFullWindowReservedArea();
-        Vector2D topL = reserved_area.topLeft, botR = reserved_area.bottomRight;
-        window->m_vPosition = Vector2D(x + topL.x + gap_x.x, max.y + max.h - get_geom_h() + topL.y + gap);
+        Extents reserved_area = window->get_reserved_area();
+        Vector2D topL = reserved_area.top_left;
+        window->set_position(Vector2D(x + topL.x + gap_x.x, max.y + max.h - get_geom_h() + topL.y + gap));
     }
     void move_to_top(double x, const Box &max, const Vector2D &gap_x, double gap) {
-        SBoxExtents reserved_area = window->getFullWindowReservedArea();
-        Vector2D topL = reserved_area.topLeft, botR = reserved_area.bottomRight;
-        window->m_vPosition = Vector2D(x + topL.x + gap_x.x, max.y + topL.y + gap);
+        Extents reserved_area = window->get_reserved_area();
+        Vector2D topL = reserved_area.top_left;
+        window->set_position(Vector2D(x + topL.x + gap_x.x, max.y + topL.y + gap));
     }
     void move_to_center(double x, const Box &max, const Vector2D &gap_x, double gap0, double gap1) {
-        SBoxExtents reserved_area = window->getFullWindowReservedArea();
-        Vector2D topL = reserved_area.topLeft, botR = reserved_area.bottomRight;
-        window->m_vPosition = Vector2D(x + topL.x + gap_x.x, max.y + 0.5 * (max.h - (botR.y - topL.y + gap1 - gap0 + window->m_vSize.y)));
+        Extents reserved_area = window->get_reserved_area();
+        Vector2D topL = reserved_area.top_left, botR = reserved_area.bottom_right;
+        window->set_position(Vector2D(x + topL.x + gap_x.x, max.y + 0.5 * (max.h - (botR.y - topL.y + gap1 - gap0 + window->get_size().y))));
     }
     void move_to_pos(double x, double y, const Vector2D &gap_x, double gap) {
-        SBoxExtents reserved_area = window->getFullWindowReservedArea();
-        Vector2D topL = reserved_area.topLeft, botR = reserved_area.bottomRight;
-        window->m_vPosition = Vector2D(x + topL.x + gap_x.x, y + gap + topL.y);
+        Extents reserved_area = window->get_reserved_area();
+        Vector2D topL = reserved_area.top_left;
+        window->set_position(Vector2D(x + topL.x + gap_x.x, y + gap + topL.y));
     }
 
     void scroll(double delta_y) {
-        window->m_vPosition.y += delta_y;
-        window->m_vRealPosition->warp(false);
-        *window->m_vRealPosition = window->m_vPosition;
+        window->set_position(window->get_position() + Vector2D(0.0, delta_y));
+        window->commit_position(false);
     }
 
     void update_window(double w, const Vector2D &gap_x, double gap0, double gap1, bool animate) {
-        auto reserved = window->getFullWindowReservedArea();
+        auto reserved = window->get_reserved_area();
         //win->m_vSize = Vector2D(w - gap_x.x - gap_x.y, wh - gap0 - gap1);
-        window->m_vSize = Vector2D(std::max(w - reserved.topLeft.x - reserved.bottomRight.x - gap_x.x - gap_x.y, 1.0), std::max(get_geom_h() - reserved.topLeft.y - reserved.bottomRight.y - gap0 - gap1, 1.0));
-        if (!animate)
-            window->m_vRealPosition->warp(false);
-        *window->m_vRealPosition = window->m_vPosition;
-        *window->m_vRealSize = window->m_vSize;
-        window->sendWindowSize();
+        window->set_size(Vector2D(std::max(w - reserved.top_left.x - reserved.bottom_right.x - gap_x.x - gap_x.y, 1.0), std::max(get_geom_h() - reserved.top_left.y - reserved.bottom_right.y - gap0 - gap1, 1.0)));
+        commit(animate);
     }
     bool can_resize_width(double geomw, double maxw, const Vector2D &gap_x, double gap, double deltax) {
         // First, check if resize is possible or it would leave any window
         // with an invalid size.
-        SBoxExtents reserved_area = window->getFullWindowReservedArea();
-        Vector2D topL = reserved_area.topLeft, botR = reserved_area.bottomRight;
+        Extents reserved_area = window->get_reserved_area();
+        Vector2D topL = reserved_area.top_left, botR = reserved_area.bottom_right;
         // Width check
         auto rwidth = geomw + deltax - topL.x - botR.x - gap_x.x - gap_x.y;
         // Now we check for a size smaller than the maximum possible gap, so
@@ -139,8 +168,8 @@ public:
         return true;
     }
     bool can_resize_height(double maxh, bool active, double gap0, double gap1, double deltay) {
-        SBoxExtents reserved_area = window->getFullWindowReservedArea();
-        const Vector2D topL = reserved_area.topLeft, botR = reserved_area.bottomRight;
+        Extents reserved_area = window->get_reserved_area();
+        const Vector2D topL = reserved_area.top_left, botR = reserved_area.bottom_right;
         auto wh = get_geom_h() - gap0 - gap1 - topL.y - botR.y;
         if (active)
             wh += deltay;
@@ -149,14 +178,14 @@ public:
         return true;
     }
 
-    CGradientValueData get_border_color() const;
-
     void selection_toggle() {
         selected = !selected;
+        window->set_selected(selected);
     }
 
     void selection_set() {
         selected = true;
+        window->set_selected(selected);
     }
 
     void selection_reset() {
@@ -166,22 +195,17 @@ public:
 
     bool is_selected() const { return selected; }
 
-    void move_to_workspace(PHLWORKSPACE workspace) {
-        window->moveToWorkspace(workspace);
-        window->m_pMonitor = workspace->m_pMonitor;
+    void move_to_workspace(WorkspaceID workspace) {
+        window->move_to_workspace(workspace);
     }
 
     void pin(bool pin) {
-        if (pin) {
-            window->m_tags.applyTag("+scroller:pinned");
-        } else {
-            window->m_tags.applyTag("-scroller:pinned");
-        }
-        window->updateDynamicRules();
-        g_pCompositor->updateWindowAnimatedDecorationValues(window.lock());
+        window->pin(pin);
     }
 
 private:
+    friend class LayoutPlan;
+
     struct Memory {
         double pos_y;
         double box_h;
@@ -189,25 +213,31 @@ private:
         Vector2D vSize;
     };
 
+    // Sends the new size to the client, once the plan is applied if there
+    // is one open
+    void commit(bool animate) {
+        if (!LayoutPlan::add(this, animate))
+            apply(animate);
+    }
+    void apply(bool animate) {
+        if (window->commit(animate))
+            layout_stats.configure();
+    }
     void push_geom(Memory &mem) {
-        PHLWINDOW w = window.lock();
         mem.box_h = box_h;
-        mem.pos_y = w->m_vPosition.y;
-        mem.vPosition = w->m_vPosition;
-        mem.vSize = w->m_vSize;
+        mem.pos_y = window->get_position().y;
+        mem.vPosition = window->get_position();
+        mem.vSize = window->get_size();
     }
     void pop_geom(const Memory &mem) {
-        PHLWINDOW w = window.lock();
         box_h = mem.box_h;
-        w->m_vPosition.y = mem.pos_y;
-        w->m_vPosition = mem.vPosition;
-        w->m_vSize = mem.vSize;
-        *w->m_vRealPosition = w->m_vPosition;
-        *w->m_vRealSize = w->m_vSize;
-        w->sendWindowSize();
+        window->set_position(mem.vPosition);
+        window->set_size(mem.vSize);
+        commit(true);
     }
 
-    PHLWINDOWREF window;
+    WindowAdapter *window;
+    WindowID id;
     StandardSize height;
     // This keeps track of the window width and recovers it when it is alone
     // in a column. When it is in a column with more windows, the active window
@@ -221,7 +251,8 @@ private:
     double box_h;
     Memory mem_ov, mem_fs;   // memory to store old height and win y when in overview/fullscreen modes
     bool selected;
-    SelectionBorders *decoration;
+    // Index in LayoutPlan::pending, -1 if it isn't in the open plan
+    int plan_index = -1;
 };
 
 #endif // SCROLLER_WINDOW_H
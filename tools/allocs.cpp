@@ -0,0 +1,238 @@
+#include <cstdlib>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "marks.h"
+#include "mock.h"
+#include "row.h"
+
+// Heap allocation budget for the focus and move hot paths, on the mock
+// adapters.
+//
+// Replaces the global operator new to count allocations, runs every focus
+// and move operation on a row many times after a warm up, and exits with an
+// error if any of them allocates more per call than its budget. Operations
+// that only move the focus or reorder existing nodes must not allocate at
+// all; the ones that move a window to another column create that column or
+// list node, so their budget is the number of nodes they need.
+
+static bool counting = false;
+static uint64_t allocations = 0;
+
+static void *allocate(std::size_t size)
+{
+    if (counting)
+        allocations++;
+    if (size == 0)
+        size = 1;
+    void *p = std::malloc(size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+static void *allocate(std::size_t size, std::align_val_t align)
+{
+    if (counting)
+        allocations++;
+    const std::size_t alignment = static_cast<std::size_t>(align);
+    size = (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    void *p = std::aligned_alloc(alignment, size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(std::size_t size) { return allocate(size); }
+void *operator new[](std::size_t size) { return allocate(size); }
+void *operator new(std::size_t size, std::align_val_t align) { return allocate(size, align); }
+void *operator new[](std::size_t size, std::align_val_t align) { return allocate(size, align); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+// The shared fixture with a marked window and a trail. Emitted IPC events
+// are only counted: the plugin hands them to Hyprland, the allocations that
+// matter are the ones the core and the event bus make.
+class Workspace {
+public:
+    Workspace(int ncolumns, int nwindows)
+        : fixture(ncolumns, nwindows), marks(&fixture.get_layout()), trails(&fixture.get_layout()), events(0) {
+        fixture.focus_middle();
+        const auto &windows = fixture.get_windows();
+        marks.add(windows[0]->get_id(), "a");
+        trails.trail_new();
+        for (size_t i = 0; i < windows.size(); i += 3)
+            trails.trailmark_toggle(windows[i]->get_id());
+    }
+    Row *get_row() { return fixture.get_row(); }
+    Marks &get_marks() { return marks; }
+    Trails &get_trails() { return trails; }
+    const std::vector<MockWindow *> &get_windows() const { return fixture.get_windows(); }
+    void flush_events() {
+        fixture.get_layout().flush_events([this](std::string_view) { events++; });
+    }
+    int get_events() const { return events; }
+    void clear_events() { events = 0; }
+
+private:
+    MockWorkspace fixture;
+    Marks marks;
+    Trails trails;
+    int events;
+};
+
+struct Operation {
+    const char *name;
+    // Allowed allocations per call
+    double budget;
+    std::function<void (Workspace &, int)> run;
+};
+
+// Operations alternate directions on even and odd calls, so the layout
+// goes back and forth instead of piling up at one end of the row.
+static const Operation operations[] = {
+    { "move_focus left/right", 0, [](Workspace &w, int i) {
+        w.get_row()->move_focus(i % 2 ? Direction::Left : Direction::Right, false);
+    } },
+    { "move_focus up/down", 0, [](Workspace &w, int i) {
+        w.get_row()->move_focus(i % 2 ? Direction::Up : Direction::Down, false);
+    } },
+    { "move_focus begin/end", 0, [](Workspace &w, int i) {
+        w.get_row()->move_focus(i % 2 ? Direction::Begin : Direction::End, false);
+    } },
+    { "move_focus wrap", 0, [](Workspace &w, int i) {
+        w.get_row()->move_focus(Direction::Right, true);
+    } },
+    { "focus_window", 0, [](Workspace &w, int i) {
+        const auto &windows = w.get_windows();
+        w.get_row()->focus_window(windows[(i * 7) % windows.size()]->get_id());
+    } },
+    { "move_active_column left/right", 0, [](Workspace &w, int i) {
+        w.get_row()->move_active_column(i % 2 ? Direction::Left : Direction::Right);
+    } },
+    { "move_active_column up/down", 0, [](Workspace &w, int i) {
+        w.get_row()->move_active_column(i % 2 ? Direction::Up : Direction::Down);
+    } },
+    { "move_active_column begin/end", 0, [](Workspace &w, int i) {
+        w.get_row()->move_active_column(i % 2 ? Direction::Begin : Direction::End);
+    } },
+    { "move_active_window up/down", 0, [](Workspace &w, int i) {
+        w.get_row()->move_active_window(i % 2 ? Direction::Up : Direction::Down);
+    } },
+    // Out of its column and back in: a Column and two list nodes on the way
+    // out, one list node on the way back. The Window moves with it.
+    { "move_active_window left/right", 2, [](Workspace &w, int i) {
+        w.get_row()->move_active_window(i % 2 ? Direction::Left : Direction::Right);
+    } },
+    { "align_column", 0, [](Workspace &w, int i) {
+        static const Direction directions[] = { Direction::Left, Direction::Right, Direction::Center, Direction::Middle };
+        w.get_row()->align_column(directions[i % 4]);
+    } },
+    // Touchpad swipes, one update per event
+    { "scroll_update left/right", 0, [](Workspace &w, int i) {
+        w.get_row()->scroll_update(i % 2 ? Direction::Left : Direction::Right, Vector2D(i % 2 ? -40.0 : 40.0, 0.0));
+    } },
+    { "scroll_update up/down", 0, [](Workspace &w, int i) {
+        w.get_row()->scroll_update(i % 2 ? Direction::Up : Direction::Down, Vector2D(0.0, i % 2 ? -40.0 : 40.0));
+    } },
+    { "set_mode_modifier", 0, [](Workspace &w, int i) {
+        static const ModeModifier modifier;
+        w.get_row()->set_mode_modifier(modifier);
+    } },
+    // Events the plugin posts on every workspace and window focus change
+    { "focus change events", 0, [](Workspace &w, int i) {
+        w.get_row()->post_event(EventTopic::Mode);
+        w.get_row()->post_event(EventTopic::Overview);
+        w.get_marks().post_mark_event(w.get_windows()[i % 2]->get_id());
+        w.get_trails().post_trailmark_event(w.get_windows()[i % 2]->get_id());
+    } },
+    { "trailmark_next/prev", 0, [](Workspace &w, int i) {
+        if (i % 2)
+            w.get_trails().trailmark_prev();
+        else
+            w.get_trails().trailmark_next();
+    } },
+};
+
+static void usage(const char *name)
+{
+    std::cerr << "usage: " << name << " [options]\n"
+              << "  --columns N     columns in the row (default 20)\n"
+              << "  --windows N     windows per column (default 4)\n"
+              << "  --iterations N  calls per operation (default 1000)\n";
+}
+
+int main(int argc, char **argv)
+{
+    int ncolumns = 20, nwindows = 4, iterations = 1000;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--columns") {
+            ncolumns = std::atoi(argv[++i]);
+        } else if (i + 1 < argc && arg == "--windows") {
+            nwindows = std::atoi(argv[++i]);
+        } else if (i + 1 < argc && arg == "--iterations") {
+            iterations = std::atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (ncolumns < 3 || nwindows < 2 || iterations < 2) {
+        std::cerr << "need at least 3 columns, 2 windows per column and 2 iterations\n";
+        return 1;
+    }
+
+    bool failed = false;
+    std::cout << std::format("{:<32} {:>12} {:>8} {:>8}\n", "operation", "allocs/call", "budget", "events");
+    for (const auto &op : operations) {
+        Workspace workspace(ncolumns, nwindows);
+        // Warm up: the first calls may reach states the row hasn't been in
+        for (int i = 0; i < 2; ++i) {
+            op.run(workspace, i);
+            workspace.flush_events();
+        }
+        workspace.clear_events();
+
+        allocations = 0;
+        counting = true;
+        for (int i = 0; i < iterations; ++i) {
+            op.run(workspace, i);
+            workspace.flush_events();
+        }
+        counting = false;
+
+        const double per_call = static_cast<double>(allocations) / iterations;
+        const bool over = per_call > op.budget;
+        failed = failed || over;
+        std::cout << std::format("{:<32} {:>12.2f} {:>8.2f} {:>8}{}\n", op.name, per_call, op.budget,
+                                 workspace.get_events(), over ? "  OVER BUDGET" : "");
+    }
+    return failed ? 1 : 0;
+}
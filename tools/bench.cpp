@@ -0,0 +1,235 @@
+#include <format>
+
+#include <benchmark/benchmark.h>
+
+#include "mock.h"
+#include "row.h"
+
+// Layout hot path benchmarks, run on the mock adapters.
+//
+// Common parameters:
+//   columns: number of columns in the row
+//   windows: number of windows per column
+//   pinned:  1 to pin the first column
+//   lazy:    1 to use Reorder::Lazy (set by align_column), 0 for Reorder::Auto
+//   center:  1 to enable center_active_column
+//
+// Write machine readable results with:
+//   hyprscroller-bench --benchmark_out=results.json --benchmark_out_format=json
+// and compare two runs with tools/bench_compare.py
+
+static void setup_row(MockWorkspace &workspace, const benchmark::State &state)
+{
+    Row *row = workspace.get_row();
+    workspace.get_layout().config().center_active_column = state.range(4) != 0;
+    if (state.range(2)) {
+        // Pin the first column, and go back to the middle
+        row->move_focus(Direction::Begin, false);
+        row->pin();
+    }
+    workspace.focus_middle();
+    if (state.range(3)) {
+        row->align_column(Direction::Left);
+    }
+}
+
+static void set_counters(benchmark::State &state)
+{
+    state.counters["total_windows"] = state.range(0) * state.range(1);
+}
+
+static void row_arguments(benchmark::internal::Benchmark *bench)
+{
+    bench->ArgNames({ "columns", "windows", "pinned", "lazy", "center" });
+    bench->ArgsProduct({ { 1, 10, 100, 1000 }, { 1, 8, 50 }, { 0, 1 }, { 0, 1 }, { 0, 1 } });
+}
+
+static void size_arguments(benchmark::internal::Benchmark *bench)
+{
+    bench->ArgNames({ "columns", "windows" });
+    bench->ArgsProduct({ { 1, 10, 100, 1000 }, { 1, 8, 50 } });
+}
+
+static void BM_recalculate_row_geometry(benchmark::State &state)
+{
+    MockWorkspace workspace(state.range(0), state.range(1));
+    setup_row(workspace, state);
+    Row *row = workspace.get_row();
+    for (auto _ : state) {
+        row->recalculate_row_geometry();
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_recalculate_row_geometry)->Apply(row_arguments);
+
+// Row::adjust_columns() is private. With center_active_column on and no pinned
+// column, recalculate_row_geometry() only places the active column and calls
+// it, so this measures adjust_columns() anchored at the active column.
+static void BM_adjust_columns(benchmark::State &state)
+{
+    MockWorkspace workspace(state.range(0), state.range(1));
+    workspace.get_layout().config().center_active_column = true;
+    workspace.focus_middle();
+    Row *row = workspace.get_row();
+    for (auto _ : state) {
+        row->recalculate_row_geometry();
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_adjust_columns)->Apply(size_arguments);
+
+static void BM_recalculate_col_geometry(benchmark::State &state)
+{
+    MockWorkspace workspace(1, 1);
+    Row *row = workspace.get_row();
+    const double gap = workspace.get_layout().get_viewport(0, 1).gap;
+    const Vector2D gap_x(gap, gap);
+    Column column(workspace.new_window(), row);
+    for (int w = 1; w < state.range(0); ++w)
+        column.add_active_window(workspace.new_window());
+    if (state.range(1))
+        column.align_window(Direction::Up, gap_x, gap);
+    for (auto _ : state) {
+        column.recalculate_col_geometry(gap_x, gap, true);
+    }
+}
+BENCHMARK(BM_recalculate_col_geometry)
+    ->ArgNames({ "windows", "lazy" })
+    ->ArgsProduct({ { 1, 2, 8, 20, 50 }, { 0, 1 } });
+
+// Enter and leave overview
+static void BM_toggle_overview(benchmark::State &state)
+{
+    MockWorkspace workspace(state.range(0), state.range(1));
+    workspace.focus_middle();
+    Row *row = workspace.get_row();
+    for (auto _ : state) {
+        row->toggle_overview();
+        row->toggle_overview();
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_toggle_overview)->Apply(size_arguments);
+
+static void BM_fit_size(benchmark::State &state, FitSize fitsize)
+{
+    MockWorkspace workspace(state.range(0), state.range(1));
+    workspace.focus_middle();
+    Row *row = workspace.get_row();
+    for (auto _ : state) {
+        row->fit_size(fitsize);
+    }
+    set_counters(state);
+}
+BENCHMARK_CAPTURE(BM_fit_size, all, FitSize::All)->Apply(size_arguments);
+BENCHMARK_CAPTURE(BM_fit_size, visible, FitSize::Visible)->Apply(size_arguments);
+
+// Move every column of a row to another and back
+static void BM_selection_move(benchmark::State &state)
+{
+    MockWorkspace workspace(state.range(0), state.range(1), 1);
+    Row *row = workspace.get_row();
+    Row *other = workspace.add_row(2, 1, 1);
+    for (auto _ : state) {
+        List<Column *> selection;
+        row->selection_all();
+        row->selection_get(other, selection);
+        other->selection_move(selection, Direction::End);
+        selection.clear();
+        other->selection_all();
+        other->selection_get(row, selection);
+        row->selection_move(selection, Direction::End);
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_selection_move)->Apply(size_arguments);
+
+// Admit the active window into the column on its left, and expel it back
+static void BM_admit_expel(benchmark::State &state)
+{
+    MockWorkspace workspace(state.range(0), state.range(1));
+    workspace.focus_middle();
+    Row *row = workspace.get_row();
+    for (auto _ : state) {
+        row->admit_window(AdmitExpelDirection::Left);
+        row->expel_window(AdmitExpelDirection::Right);
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_admit_expel)->Apply(size_arguments);
+
+// Build a row from existing windows, as enabling the layout does: one by
+// one (load = 0), or bulk loaded and laid out once (load = 1)
+static void BM_load(benchmark::State &state)
+{
+    MockWorkspace workspace(0, 0);
+    std::vector<WindowAdapter *> windows;
+    for (int w = 0; w < state.range(0) * state.range(1); ++w)
+        windows.push_back(workspace.new_window());
+    for (auto _ : state) {
+        Row row(2, &workspace.get_layout());
+        if (state.range(2))
+            row.begin_load();
+        for (int c = 0; c < state.range(0); ++c) {
+            row.set_mode(Mode::Row, true);
+            row.add_active_window(windows[c * state.range(1)]);
+            row.set_mode(Mode::Column, true);
+            for (int w = 1; w < state.range(1); ++w)
+                row.add_active_window(windows[c * state.range(1) + w]);
+        }
+        if (state.range(2))
+            row.end_load();
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_load)
+    ->ArgNames({ "columns", "windows", "load" })
+    ->ArgsProduct({ { 1, 10, 100, 1000 }, { 1, 8 }, { 0, 1 } });
+
+// ScrollerSizes lookups for a number of configured monitors, the one we
+// look for being the last
+static std::string monitor_options(int nmonitors)
+{
+    std::string options = "(";
+    for (int m = 0; m < nmonitors; ++m) {
+        if (m > 0)
+            options += ", ";
+        options += std::format("MON-{} = (mode = row; column_default_width = onehalf; column_widths = onethird onehalf twothirds one; window_default_height = one)", m);
+    }
+    return options + ")";
+}
+
+static void BM_sizes_lookup(benchmark::State &state)
+{
+    const int nmonitors = state.range(0);
+    const std::string options = monitor_options(nmonitors);
+    const std::string name = std::format("MON-{}", nmonitors - 1);
+    ScrollerSizes sizes;
+    sizes.update("one", "onehalf", "onethird onehalf twothirds one", "onethird onehalf twothirds one", options, true);
+    MockWindow window(1, name);
+    StandardSize size = StandardSize::OneHalf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sizes.get_mode(name));
+        benchmark::DoNotOptimize(sizes.get_column_default_width(&window));
+        benchmark::DoNotOptimize(sizes.get_window_default_height(&window));
+        benchmark::DoNotOptimize(sizes.get_column_closest_width(name, 0.4, 1));
+        size = sizes.get_next_column_width(name, size, 1);
+        benchmark::DoNotOptimize(size);
+    }
+}
+BENCHMARK(BM_sizes_lookup)->ArgName("monitors")->Arg(1)->Arg(4)->Arg(16);
+
+// The adapter calls update() every time the sizes are requested, the
+// configuration is usually unchanged
+static void BM_sizes_update_unchanged(benchmark::State &state)
+{
+    const std::string options = monitor_options(state.range(0));
+    ScrollerSizes sizes;
+    sizes.update("one", "onehalf", "onethird onehalf twothirds one", "onethird onehalf twothirds one", options, true);
+    for (auto _ : state) {
+        sizes.update("one", "onehalf", "onethird onehalf twothirds one", "onethird onehalf twothirds one", options, true);
+    }
+}
+BENCHMARK(BM_sizes_update_unchanged)->ArgName("monitors")->Arg(1)->Arg(4)->Arg(16);
+
+BENCHMARK_MAIN();
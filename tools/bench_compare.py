@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+#
+# Compare two hyprscroller-bench JSON result files and flag regressions.
+#
+#   hyprscroller-bench --benchmark_out=base.json --benchmark_out_format=json
+#   (apply changes, rebuild)
+#   hyprscroller-bench --benchmark_out=new.json --benchmark_out_format=json
+#   tools/bench_compare.py base.json new.json
+#
+# When the runs use --benchmark_repetitions, the median is compared.
+# Exits with status 1 if any benchmark is slower than the threshold.
+
+import argparse
+import json
+import statistics
+import sys
+
+
+def load(path, metric):
+    with open(path) as f:
+        data = json.load(f)
+    runs = {}
+    medians = {}
+    for bench in data.get("benchmarks", []):
+        if bench.get("error_occurred"):
+            continue
+        name = bench.get("run_name", bench["name"])
+        if bench.get("run_type") == "aggregate":
+            if bench.get("aggregate_name") == "median":
+                medians[name] = bench[metric]
+        else:
+            runs.setdefault(name, []).append(bench[metric])
+    results = {name: statistics.median(values) for name, values in runs.items()}
+    results.update(medians)
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two hyprscroller-bench runs")
+    parser.add_argument("base", help="baseline JSON results")
+    parser.add_argument("new", help="new JSON results")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="percentage slowdown reported as a regression (default: 10)")
+    parser.add_argument("--metric", choices=["real_time", "cpu_time"], default="cpu_time",
+                        help="time to compare (default: cpu_time)")
+    parser.add_argument("--all", action="store_true", help="show every benchmark, not only changes")
+    args = parser.parse_args()
+
+    base = load(args.base, args.metric)
+    new = load(args.new, args.metric)
+
+    regressions = 0
+    improvements = 0
+    width = max((len(name) for name in base.keys() & new.keys()), default=10)
+    print(f"{'benchmark':<{width}}  {'base':>12}  {'new':>12}  {'change':>8}")
+    for name in sorted(base.keys() & new.keys()):
+        b, n = base[name], new[name]
+        change = (n - b) / b * 100.0 if b > 0 else 0.0
+        if change > args.threshold:
+            status = "REGRESSION"
+            regressions += 1
+        elif change < -args.threshold:
+            status = "improved"
+            improvements += 1
+        else:
+            status = ""
+        if status or args.all:
+            print(f"{name:<{width}}  {b:>12.1f}  {n:>12.1f}  {change:>+7.1f}%  {status}")
+
+    for name in sorted(base.keys() - new.keys()):
+        print(f"{name}: missing in {args.new}")
+    for name in sorted(new.keys() - base.keys()):
+        print(f"{name}: new in {args.new}")
+
+    print(f"\n{regressions} regressions, {improvements} improvements (threshold {args.threshold}%)")
+    return 1 if regressions > 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
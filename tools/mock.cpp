@@ -0,0 +1,174 @@
+#include "mock.h"
+#include "row.h"
+
+static const std::string no_monitor;
+
+// MockWindow
+MockWindow::MockWindow(WindowID id, const std::string &monitor, double border)
+    : id(id), monitor(monitor), commits(0), fullscreen(FullscreenMode::None),
+      selected(false), pinned(false), no_initial_focus(false), workspace(-1)
+{
+    reserved.top_left = Vector2D(border, border);
+    reserved.bottom_right = Vector2D(border, border);
+}
+
+std::vector<std::string> MockWindow::get_rules(const std::string &name) const
+{
+    const auto rule = rules.find(name);
+    if (rule != rules.end())
+        return rule->second;
+    return {};
+}
+
+bool MockWindow::commit(bool /* animate */)
+{
+    if (committed_position == position && committed_size == size)
+        return false;
+    committed_position = position;
+    committed_size = size;
+    commits++;
+    return true;
+}
+
+void MockWindow::commit_position(bool /* animate */)
+{
+    committed_position = position;
+}
+
+void MockWindow::toggle_fullscreen(FullscreenMode mode)
+{
+    fullscreen = fullscreen != FullscreenMode::None ? FullscreenMode::None : mode;
+}
+
+// MockLayout
+MockLayout::MockLayout() : active_monitor(-1), gaps_in(5), gaps_out(20)
+{
+    set_sizes("one", "onehalf", "onethird onehalf twothirds one", "onethird onehalf twothirds one", "", true);
+}
+
+MonitorID MockLayout::add_monitor(const std::string &name, const Box &full)
+{
+    const MonitorID monitor = monitors.empty() ? 0 : monitors.rbegin()->first + 1;
+    set_monitor(monitor, name, full);
+    return monitor;
+}
+
+void MockLayout::set_monitor(MonitorID monitor, const std::string &name, const Box &full)
+{
+    auto m = monitors.find(monitor);
+    if (m != monitors.end()) {
+        m->second.name = name;
+        m->second.full = full;
+    } else {
+        monitors[monitor] = { name, full, Box() };
+    }
+    if (active_monitor == -1)
+        active_monitor = monitor;
+}
+
+void MockLayout::set_sizes(const std::string &window_default_height, const std::string &column_default_width,
+                           const std::string &window_heights, const std::string &column_widths,
+                           const std::string &monitor_options, bool cyclesize_wrap)
+{
+    sizes.update(window_default_height, column_default_width, window_heights, column_widths, monitor_options, cyclesize_wrap);
+}
+
+const std::string &MockLayout::get_monitor_name(MonitorID monitor) const
+{
+    const auto m = monitors.find(monitor);
+    if (m == monitors.end())
+        return no_monitor;
+    return m->second.name;
+}
+
+Viewport MockLayout::get_viewport(MonitorID monitor, WorkspaceID workspace) const
+{
+    const auto v = viewports.find({ monitor, workspace });
+    if (v != viewports.end())
+        return v->second;
+    Viewport viewport;
+    const auto it = monitors.find(monitor);
+    if (it == monitors.end())
+        return viewport;
+    const Monitor &m = it->second;
+    viewport.full = m.full;
+    viewport.max = Box(m.full.x + m.reserved.x + gaps_out,
+                       m.full.y + m.reserved.y + gaps_out,
+                       m.full.w - m.reserved.x - m.reserved.w - 2 * gaps_out,
+                       m.full.h - m.reserved.y - m.reserved.h - 2 * gaps_out);
+    viewport.gap = gaps_in;
+    return viewport;
+}
+
+MonitorID MockLayout::get_workspace_monitor(WorkspaceID workspace) const
+{
+    const auto w = workspaces.find(workspace);
+    return w != workspaces.end() ? w->second.first : active_monitor;
+}
+
+bool MockLayout::is_workspace_visible(WorkspaceID workspace) const
+{
+    const auto w = workspaces.find(workspace);
+    return w == workspaces.end() || w->second.second;
+}
+
+bool MockLayout::has_monitor_in_direction(Direction direction) const
+{
+    const auto m = monitors_in_direction.find(direction);
+    return m != monitors_in_direction.end() && m->second;
+}
+
+// MockWorkspace
+static const std::string workspace_monitor = "DP-1";
+
+MockWorkspace::MockWorkspace(int ncolumns, int nwindows, WorkspaceID id) : middle(0), next_id(1)
+{
+    layout.set_active_monitor(layout.add_monitor(workspace_monitor, Box(0, 0, 2560, 1440)));
+    row = new Row(id, &layout);
+    fill(row, ncolumns, nwindows);
+}
+
+MockWorkspace::~MockWorkspace()
+{
+    for (auto other : others)
+        delete other;
+    delete row;
+    for (auto window : windows)
+        delete window;
+}
+
+Row *MockWorkspace::add_row(WorkspaceID id, int ncolumns, int nwindows)
+{
+    Row *other = new Row(id, &layout);
+    fill(other, ncolumns, nwindows);
+    others.push_back(other);
+    return other;
+}
+
+MockWindow *MockWorkspace::new_window()
+{
+    MockWindow *window = new MockWindow(next_id++, workspace_monitor, 2.0);
+    windows.push_back(window);
+    return window;
+}
+
+void MockWorkspace::focus_middle()
+{
+    if (middle != 0)
+        row->focus_window(middle);
+}
+
+void MockWorkspace::fill(Row *r, int ncolumns, int nwindows)
+{
+    for (int c = 0; c < ncolumns; ++c) {
+        r->set_mode(Mode::Row, true);
+        MockWindow *first = new_window();
+        r->add_active_window(first);
+        if (r == row && c == ncolumns / 2)
+            middle = first->get_id();
+        r->set_mode(Mode::Column, true);
+        for (int w = 1; w < nwindows; ++w)
+            r->add_active_window(new_window());
+    }
+    r->set_mode(Mode::Row, true);
+}
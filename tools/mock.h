@@ -0,0 +1,180 @@
+#ifndef SCROLLER_MOCK_H
+#define SCROLLER_MOCK_H
+
+#include <map>
+#include <utility>
+#include <string>
+#include <vector>
+
+#include "adapter.h"
+#include "sizes.h"
+
+// Mock adapters for running the layout core without a compositor. Windows
+// store the committed geometry so tools can inspect and compare layouts.
+
+class Row;
+
+class MockWindow : public WindowAdapter {
+public:
+    MockWindow(WindowID id, const std::string &monitor, double border = 0.0);
+    virtual ~MockWindow() {}
+
+    // Committed (what the client would see) geometry
+    const Vector2D &get_committed_position() const { return committed_position; }
+    const Vector2D &get_committed_size() const { return committed_size; }
+    int get_commits() const { return commits; }
+    bool is_selected() const { return selected; }
+    bool is_pinned() const { return pinned; }
+    WorkspaceID get_workspace() const { return workspace; }
+    void set_reserved_area(const Extents &extents) { reserved = extents; }
+    // Set by the compositor before it asks the layout to change the mode
+    void set_fullscreen_mode(FullscreenMode mode) { fullscreen = mode; }
+    void add_rule(const std::string &name, const std::string &value) { rules[name].push_back(value); }
+
+    virtual WindowID get_id() const { return id; }
+    virtual const std::string &get_monitor_name() const { return monitor; }
+    virtual std::vector<std::string> get_rules(const std::string &name) const;
+
+    virtual Extents get_reserved_area() const { return reserved; }
+    virtual const Vector2D &get_position() const { return position; }
+    virtual void set_position(const Vector2D &p) { position = p; }
+    virtual const Vector2D &get_size() const { return size; }
+    virtual void set_size(const Vector2D &s) { size = s; }
+    virtual bool commit(bool animate);
+    virtual void commit_position(bool animate);
+
+    virtual FullscreenMode get_fullscreen_mode() const { return fullscreen; }
+    virtual void toggle_fullscreen(FullscreenMode mode);
+
+    virtual void set_selected(bool s) { selected = s; }
+    virtual void damage() {}
+    virtual void pin(bool p) { pinned = p; }
+    virtual void move_to_workspace(WorkspaceID w) { workspace = w; }
+    virtual void set_no_initial_focus() { no_initial_focus = true; }
+
+    virtual void focus() {}
+    virtual void force_focus() {}
+    virtual void warp_cursor() {}
+    virtual void update_relative_cursor_coords() {}
+
+private:
+    WindowID id;
+    std::string monitor;
+    std::map<std::string, std::vector<std::string>> rules;
+    Extents reserved;
+    Vector2D position, size;
+    Vector2D committed_position, committed_size;
+    int commits;
+    FullscreenMode fullscreen;
+    bool selected;
+    bool pinned;
+    bool no_initial_focus;
+    WorkspaceID workspace;
+};
+
+class MockLayout : public LayoutAdapter {
+public:
+    struct Monitor {
+        std::string name;
+        Box full;
+        Box reserved;   // x, y: top left; w, h: bottom right
+    };
+
+    MockLayout();
+    virtual ~MockLayout() {}
+
+    // Returns the new monitor id
+    MonitorID add_monitor(const std::string &name, const Box &full);
+    // Adds or updates a monitor with a given id
+    void set_monitor(MonitorID monitor, const std::string &name, const Box &full);
+    // Use this viewport instead of the one calculated from the monitor and gaps
+    void set_viewport(MonitorID monitor, WorkspaceID workspace, const Viewport &viewport) {
+        viewports[{ monitor, workspace }] = viewport;
+    }
+    void set_monitor_in_direction(Direction direction, bool exists) { monitors_in_direction[direction] = exists; }
+    void set_active_monitor(MonitorID monitor) { active_monitor = monitor; }
+    void set_workspace(WorkspaceID workspace, MonitorID monitor, bool visible) {
+        workspaces[workspace] = { monitor, visible };
+    }
+    void set_gaps(int in, int out) { gaps_in = in; gaps_out = out; }
+    void set_mouse_coords(const Vector2D &coords) { mouse = coords; }
+    LayoutConfig &config() { return layout_config; }
+    // Same format and defaults as the plugin:scroller options
+    void set_sizes(const std::string &window_default_height, const std::string &column_default_width,
+                   const std::string &window_heights, const std::string &column_widths,
+                   const std::string &monitor_options, bool cyclesize_wrap);
+    // Emits the events posted since the last flush to get_events(), like
+    // the plugin does at the end of each event loop iteration
+    void flush_events() {
+        bus.flush([this](std::string_view data) { events.emplace_back(data); });
+    }
+    // Same, handing the events to emit instead of storing them
+    template <typename Emit>
+    void flush_events(Emit emit) { bus.flush(emit); }
+    const std::vector<std::string> &get_events() const { return events; }
+    void clear_events() { events.clear(); }
+
+    virtual const LayoutConfig &get_config() { return layout_config; }
+    virtual ScrollerSizes &get_sizes() { return sizes; }
+
+    virtual MonitorID get_active_monitor() const { return active_monitor; }
+    virtual const std::string &get_monitor_name(MonitorID monitor) const;
+    virtual Viewport get_viewport(MonitorID monitor, WorkspaceID workspace) const;
+    virtual MonitorID get_workspace_monitor(WorkspaceID workspace) const;
+    virtual bool is_workspace_visible(WorkspaceID workspace) const;
+    virtual bool has_monitor_in_direction(Direction direction) const;
+    virtual void focus_monitor_in_direction(Direction direction) {}
+    virtual Vector2D get_mouse_coords() const { return mouse; }
+    virtual void damage_workspace(WorkspaceID workspace) {}
+
+    virtual bool overview_enable(WorkspaceID workspace) { return false; }
+    virtual void overview_set_scale(WorkspaceID workspace, double scale) {}
+    virtual void overview_disable(WorkspaceID workspace) {}
+
+    virtual void post_event(EventTopic topic, std::string_view data) { bus.post(topic, data); }
+
+private:
+    LayoutConfig layout_config;
+    ScrollerSizes sizes;
+    std::map<MonitorID, Monitor> monitors;
+    std::map<std::pair<MonitorID, WorkspaceID>, Viewport> viewports;
+    // Monitor and visibility; other workspaces are visible on the active one
+    std::map<WorkspaceID, std::pair<MonitorID, bool>> workspaces;
+    std::map<Direction, bool> monitors_in_direction;
+    MonitorID active_monitor;
+    int gaps_in, gaps_out;
+    Vector2D mouse;
+    EventBus bus;
+    std::vector<std::string> events;
+};
+
+// Fixture for the tools: a row with ncolumns x nwindows mock windows, on
+// its own layout with one 2560x1440 monitor. Window ids count up from 1.
+class MockWorkspace {
+public:
+    MockWorkspace(int ncolumns, int nwindows, WorkspaceID id = 1);
+    ~MockWorkspace();
+
+    MockLayout &get_layout() { return layout; }
+    Row *get_row() { return row; }
+    const std::vector<MockWindow *> &get_windows() const { return windows; }
+    // Another row on the same layout, for moves between workspaces
+    Row *add_row(WorkspaceID id, int ncolumns, int nwindows);
+    // A window that is not in any row yet, deleted with the fixture
+    MockWindow *new_window();
+    // Focuses the first window of the middle column of the row, so moves
+    // in every direction do something
+    void focus_middle();
+
+private:
+    void fill(Row *r, int ncolumns, int nwindows);
+
+    MockLayout layout;
+    Row *row;
+    std::vector<Row *> others;
+    std::vector<MockWindow *> windows;
+    WindowID middle;
+    WindowID next_id;
+};
+
+#endif // SCROLLER_MOCK_H
@@ -0,0 +1,761 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mock.h"
+#include "record.h"
+#include "row.h"
+
+// Replays a session recorded with "scroller:record" (see src/record.h) on
+// the mock adapters, and reports how long each operation took and the
+// resulting geometry of every window.
+//
+// Operations mirror what ScrollerLayout does with the rows for each
+// dispatcher or callback, without the compositor parts. Effects the
+// compositor produces (focusing a window after a mark visit, a trail or a
+// jump, changing workspace...) are recorded as their own operations, so
+// marks, trails and jumps are no-ops here.
+
+class Replay {
+public:
+    Replay() : loading(false) {}
+    ~Replay() { clear(); }
+
+    bool run(std::istream &input);
+    void report_timings(std::ostream &output) const;
+    void report_geometry(std::ostream &output) const;
+
+private:
+    typedef std::istringstream Args;
+
+    void clear();
+    bool apply_input(const std::string &name, Args &args);
+    void execute(const std::string &name, Args &args);
+    Row *get_row(WorkspaceID workspace) const;
+    Row *get_row_for_window(WindowID window) const;
+    void delete_row(Row *row);
+
+    void open(Args &args);
+    void close(Args &args);
+    void detach(Args &args);
+    void attach(Args &args);
+    void selection_move(WorkspaceID workspace, Direction direction);
+
+    MockLayout layout;
+    List<Row *> rows;
+    std::map<WindowID, MockWindow *> windows;
+    // Windows moving to another workspace, between "detach" and "attach"
+    std::map<WindowID, Window *> detached;
+    std::map<std::string, std::vector<double>> timings;    // microseconds
+    std::map<std::string, int> unknown;
+    // Opening the windows that exist when the layout is enabled
+    bool loading;
+};
+
+template <typename T>
+static T read_enum(std::istream &args)
+{
+    int value = 0;
+    args >> value;
+    return static_cast<T>(value);
+}
+
+static Direction direction_from_char(char direction)
+{
+    switch (direction) {
+    case 'l':
+        return Direction::Left;
+    case 'r':
+        return Direction::Right;
+    case 'u':
+        return Direction::Up;
+    case 'd':
+        return Direction::Down;
+    default:
+        return Direction::Invalid;
+    }
+}
+
+static Direction align_from_string(const std::string &dir)
+{
+    if (dir == "l" || dir == "left")
+        return Direction::Left;
+    if (dir == "r" || dir == "right")
+        return Direction::Right;
+    if (dir == "u" || dir == "up")
+        return Direction::Up;
+    if (dir == "d" || dir == "dn" || dir == "down")
+        return Direction::Down;
+    if (dir == "c" || dir == "centre" || dir == "center")
+        return Direction::Center;
+    if (dir == "m" || dir == "middle")
+        return Direction::Middle;
+    return Direction::Invalid;
+}
+
+void Replay::clear()
+{
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        delete row->data();
+    }
+    rows.clear();
+    for (auto &window : windows) {
+        delete window.second;
+    }
+    windows.clear();
+    for (auto &window : detached) {
+        delete window.second;
+    }
+    detached.clear();
+}
+
+Row *Replay::get_row(WorkspaceID workspace) const
+{
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        if (row->data()->get_workspace() == workspace)
+            return row->data();
+    }
+    return nullptr;
+}
+
+Row *Replay::get_row_for_window(WindowID window) const
+{
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        if (row->data()->has_window(window))
+            return row->data();
+    }
+    return nullptr;
+}
+
+void Replay::delete_row(Row *r)
+{
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        if (row->data() == r) {
+            rows.erase(row);
+            delete r;
+            return;
+        }
+    }
+}
+
+// Records from the recorder that change the state the layout reads.
+// Returns false if name is not an input.
+bool Replay::apply_input(const std::string &name, Args &args)
+{
+    if (name == "config") {
+        LayoutConfig &config = layout.config();
+        args >> config.center_row_if_space_available >> config.center_active_column >>
+            config.center_active_window >> config.cyclesize_closest >> config.overview_scale_content;
+    } else if (name == "sizes") {
+        std::string window_default_height, column_default_width, window_heights, column_widths, monitor_options;
+        bool cyclesize_wrap;
+        args >> std::quoted(window_default_height) >> std::quoted(column_default_width) >>
+            std::quoted(window_heights) >> std::quoted(column_widths) >> std::quoted(monitor_options) >>
+            cyclesize_wrap;
+        layout.set_sizes(window_default_height, column_default_width, window_heights, column_widths,
+                         monitor_options, cyclesize_wrap);
+    } else if (name == "monitor") {
+        MonitorID monitor;
+        std::string monitor_name;
+        Box full;
+        args >> monitor >> std::quoted(monitor_name) >> full.x >> full.y >> full.w >> full.h;
+        layout.set_monitor(monitor, monitor_name, full);
+    } else if (name == "activemonitor") {
+        MonitorID monitor;
+        args >> monitor;
+        layout.set_active_monitor(monitor);
+    } else if (name == "viewport") {
+        MonitorID monitor;
+        WorkspaceID workspace;
+        Viewport viewport;
+        args >> monitor >> workspace >> viewport.full.x >> viewport.full.y >> viewport.full.w >> viewport.full.h >>
+            viewport.max.x >> viewport.max.y >> viewport.max.w >> viewport.max.h >> viewport.gap;
+        layout.set_viewport(monitor, workspace, viewport);
+    } else if (name == "workspace") {
+        WorkspaceID workspace;
+        MonitorID monitor;
+        bool visible;
+        args >> workspace >> monitor >> visible;
+        layout.set_workspace(workspace, monitor, visible);
+    } else if (name == "monitorindirection") {
+        Direction direction = read_enum<Direction>(args);
+        bool exists;
+        args >> exists;
+        layout.set_monitor_in_direction(direction, exists);
+    } else if (name == "mouse") {
+        Vector2D coords;
+        args >> coords.x >> coords.y;
+        layout.set_mouse_coords(coords);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void Replay::open(Args &args)
+{
+    WorkspaceID workspace;
+    WindowID id;
+    std::string monitor;
+    Extents reserved;
+    size_t nrules;
+    args >> workspace >> id >> std::quoted(monitor) >> reserved.top_left.x >> reserved.top_left.y >>
+        reserved.bottom_right.x >> reserved.bottom_right.y >> nrules;
+    std::vector<std::pair<std::string, std::string>> rules;
+    for (size_t i = 0; i < nrules; ++i) {
+        std::string name, value;
+        args >> std::quoted(name) >> std::quoted(value);
+        rules.push_back({ name, value });
+    }
+
+    if (get_row_for_window(id) != nullptr)
+        return;
+    // Addresses can be reused once a window is gone
+    auto old = windows.find(id);
+    if (old != windows.end()) {
+        delete old->second;
+        windows.erase(old);
+    }
+    MockWindow *window = new MockWindow(id, monitor);
+    window->set_reserved_area(reserved);
+    for (const auto &rule : rules) {
+        window->add_rule(rule.first, rule.second);
+    }
+    windows[id] = window;
+
+    Row *s = get_row(workspace);
+    if (s == nullptr) {
+        s = new Row(workspace, &layout);
+        rows.push_back(s);
+        if (loading)
+            s->begin_load();
+    }
+    s->add_active_window(window);
+
+    for (const auto &rule : rules) {
+        if (rule.first == "group") {
+            s->move_active_window_to_group(rule.second);
+        } else if (rule.first == "alignwindow") {
+            const Direction direction = align_from_string(rule.second);
+            if (direction != Direction::Invalid)
+                s->align_column(direction);
+        }
+    }
+}
+
+void Replay::close(Args &args)
+{
+    WindowID id;
+    args >> id;
+    auto d = detached.find(id);
+    if (d != detached.end()) {
+        delete d->second;
+        detached.erase(d);
+        delete windows[id];
+        windows.erase(id);
+        return;
+    }
+    Row *s = get_row_for_window(id);
+    if (s == nullptr)
+        return;
+    const bool last = !s->remove_window(id);
+    auto window = windows.find(id);
+    if (window != windows.end()) {
+        delete window->second;
+        windows.erase(window);
+    }
+    if (last)
+        delete_row(s);
+}
+
+void Replay::detach(Args &args)
+{
+    WindowID id;
+    args >> id;
+    Row *s = get_row_for_window(id);
+    if (s == nullptr || detached.contains(id))
+        return;
+    detached[id] = s->detach_window(id);
+    if (s->size() == 0)
+        delete_row(s);
+}
+
+void Replay::attach(Args &args)
+{
+    WindowID id;
+    WorkspaceID workspace;
+    args >> id >> workspace;
+    auto d = detached.find(id);
+    if (d == detached.end())
+        return;
+    Row *s = get_row(workspace);
+    if (s == nullptr) {
+        s = new Row(workspace, &layout);
+        rows.push_back(s);
+    }
+    s->attach_window(d->second);
+    detached.erase(d);
+}
+
+void Replay::selection_move(WorkspaceID workspace, Direction direction)
+{
+    bool selection = false;
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        if (row->data()->selection_exists()) {
+            selection = true;
+            break;
+        }
+    }
+    if (!selection)
+        return;
+
+    auto s = get_row(workspace);
+    bool overview_on = false;
+    if (s == nullptr) {
+        s = new Row(workspace, &layout);
+        rows.push_back(s);
+    } else {
+        overview_on = s->is_overview();
+        if (overview_on)
+            s->toggle_overview();
+    }
+    List<Column *> columns;
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        if (row->data()->size() > 0)
+            row->data()->selection_get(s, columns);
+    }
+    s->selection_move(columns, direction);
+
+    auto row = rows.first();
+    while (row != nullptr) {
+        auto next = row->next();
+        if (row->data()->size() == 0) {
+            delete row->data();
+            rows.erase(row);
+        } else {
+            bool overview = row->data()->is_overview();
+            if (overview)
+                row->data()->toggle_overview();
+            row->data()->recalculate_row_geometry();
+            if (overview)
+                row->data()->toggle_overview();
+        }
+        row = next;
+    }
+    for (auto r = rows.first(); r != nullptr; r = r->next()) {
+        r->data()->selection_reset();
+    }
+    if (overview_on)
+        s->toggle_overview();
+}
+
+void Replay::execute(const std::string &name, Args &args)
+{
+    WorkspaceID workspace = -1;
+    auto row = [&]() {
+        args >> workspace;
+        return get_row(workspace);
+    };
+
+    // The windows that exist when the layout is enabled are bulk loaded,
+    // and their rows laid out by the "load" operations that follow them.
+    // Rows kept while the layout was disabled are reconciled first, closing
+    // the windows that changed in the meantime.
+    if (name == "enable") {
+        loading = true;
+        for (auto r = rows.first(); r != nullptr; r = r->next())
+            r->data()->begin_load();
+    } else if (name != "open" && name != "close" && name != "focus" && name != "load") {
+        loading = false;
+    }
+
+    if (name == "open") {
+        open(args);
+    } else if (name == "close") {
+        close(args);
+    } else if (name == "deferlayout") {
+        args >> workspace;
+        Row *s = get_row(workspace);
+        if (s == nullptr) {
+            s = new Row(workspace, &layout);
+            rows.push_back(s);
+        }
+        s->begin_load();
+    } else if (name == "flushlayout") {
+        if (auto s = row())
+            s->end_load(true);
+    } else if (name == "detach") {
+        detach(args);
+    } else if (name == "attach") {
+        attach(args);
+    } else if (name == "focus") {
+        WindowID id;
+        // Only focus changes under the pointer record whether they scroll
+        bool scroll = true;
+        args >> id;
+        if (!(args >> scroll))
+            scroll = true;
+        if (auto s = get_row_for_window(id))
+            s->focus_window(id, scroll);
+    } else if (name == "recalculatemonitor") {
+        MonitorID monitor;
+        bool fullscreen;
+        args >> monitor;
+        Row *s = row();
+        args >> fullscreen;
+        FullscreenMode mode = read_enum<FullscreenMode>(args);
+        if (s != nullptr) {
+            const Box oldmax = s->get_max();
+            const bool force = s->update_sizes(monitor);
+            if (fullscreen)
+                s->set_fullscreen_mode_windows(mode);
+            else
+                s->update_windows(oldmax, force);
+        }
+    } else if (name == "recalculatewindow") {
+        WindowID id;
+        args >> id;
+        if (auto s = get_row_for_window(id))
+            s->recalculate_row_geometry();
+    } else if (name == "reloadconfig") {
+        // The options themselves are inputs, recorded before
+        MonitorID monitor;
+        bool changed, fullscreen;
+        args >> monitor;
+        Row *s = row();
+        args >> changed >> fullscreen;
+        FullscreenMode mode = read_enum<FullscreenMode>(args);
+        if (s != nullptr) {
+            const Box oldmax = s->get_max();
+            if (s->update_sizes(monitor) || changed) {
+                if (fullscreen)
+                    s->set_fullscreen_mode_windows(mode);
+                else
+                    s->update_windows(oldmax, true, false);
+            }
+        }
+    } else if (name == "load") {
+        Row *s = row();
+        MonitorID monitor;
+        args >> monitor;
+        if (s != nullptr) {
+            s->update_sizes(monitor);
+            s->end_load();
+        }
+    } else if (name == "recalculate") {
+        if (auto s = row())
+            s->recalculate_row_geometry();
+    } else if (name == "resizewindow") {
+        WindowID id;
+        Vector2D delta;
+        args >> id >> delta.x >> delta.y;
+        if (auto s = get_row_for_window(id))
+            s->resize_active_window(delta);
+    } else if (name == "fullscreen") {
+        WindowID id;
+        args >> id;
+        FullscreenMode current = read_enum<FullscreenMode>(args);
+        FullscreenMode mode = read_enum<FullscreenMode>(args);
+        auto window = windows.find(id);
+        if (window != windows.end())
+            window->second->set_fullscreen_mode(mode);
+        if (auto s = get_row_for_window(id))
+            s->set_fullscreen_mode(id, current, mode);
+    } else if (name == "movewindowto") {
+        WindowID id;
+        std::string direction;
+        args >> id >> std::quoted(direction);
+        const Direction dir = direction.empty() ? Direction::Invalid : direction_from_char(direction[0]);
+        auto s = get_row_for_window(id);
+        if (s != nullptr && s->is_active(id) && dir != Direction::Invalid)
+            s->move_active_column(dir);
+    } else if (name == "cyclesize" || name == "cyclewidth" || name == "cycleheight") {
+        int step;
+        Row *s = row();
+        args >> step;
+        if (s == nullptr)
+            return;
+        Mode mode = s->get_mode();
+        if (name != "cyclesize")
+            s->set_mode(name == "cyclewidth" ? Mode::Row : Mode::Column, true);
+        s->resize_active_column(step);
+        s->set_mode(mode, true);
+    } else if (name == "setsize" || name == "setwidth" || name == "setheight") {
+        std::string arg;
+        Row *s = row();
+        args >> std::quoted(arg);
+        if (s == nullptr)
+            return;
+        Mode mode = s->get_mode();
+        if (name != "setsize")
+            s->set_mode(name == "setwidth" ? Mode::Row : Mode::Column, true);
+        s->size_active_column(arg);
+        s->set_mode(mode, true);
+    } else if (name == "movefocus") {
+        Row *s = row();
+        Direction direction = read_enum<Direction>(args);
+        bool focus_wrap;
+        args >> focus_wrap;
+        if (s != nullptr)
+            s->move_focus(direction, focus_wrap);
+    } else if (name == "movewindow") {
+        Row *s = row();
+        Direction direction = read_enum<Direction>(args);
+        bool nomode;
+        args >> nomode;
+        if (s == nullptr)
+            return;
+        if (nomode)
+            s->move_active_window(direction);
+        else
+            s->move_active_column(direction);
+    } else if (name == "alignwindow") {
+        Row *s = row();
+        Direction direction = read_enum<Direction>(args);
+        if (s != nullptr)
+            s->align_column(direction);
+    } else if (name == "admitwindow" || name == "expelwindow") {
+        Row *s = row();
+        AdmitExpelDirection direction = read_enum<AdmitExpelDirection>(args);
+        if (s == nullptr)
+            return;
+        if (name == "admitwindow")
+            s->admit_window(direction);
+        else
+            s->expel_window(direction);
+    } else if (name == "setmode") {
+        Row *s = row();
+        Mode mode = read_enum<Mode>(args);
+        if (s != nullptr)
+            s->set_mode(mode);
+    } else if (name == "setmodemodifier") {
+        int position, focus, auto_mode, auto_param, center_column, center_window;
+        Row *s = row();
+        args >> position >> focus >> auto_mode >> auto_param >> center_column >> center_window;
+        if (s == nullptr)
+            return;
+        ModeModifier modifier;
+        modifier.set_position(position);
+        modifier.set_focus(focus);
+        modifier.set_auto_mode(auto_mode);
+        modifier.set_auto_param(auto_param);
+        if (center_column != -1)
+            modifier.set_center_column(center_column != 0);
+        if (center_window != -1)
+            modifier.set_center_window(center_window != 0);
+        s->set_mode_modifier(modifier);
+    } else if (name == "fitsize" || name == "fitwidth" || name == "fitheight") {
+        Row *s = row();
+        FitSize fitsize = read_enum<FitSize>(args);
+        if (s == nullptr)
+            return;
+        Mode mode = s->get_mode();
+        if (name != "fitsize")
+            s->set_mode(name == "fitwidth" ? Mode::Row : Mode::Column, true);
+        s->fit_size(fitsize);
+        s->set_mode(mode, true);
+    } else if (name == "toggleoverview") {
+        if (auto s = row())
+            s->toggle_overview();
+    } else if (name == "pin") {
+        if (auto s = row())
+            s->pin();
+    } else if (name == "selectiontoggle") {
+        if (auto s = row())
+            s->selection_toggle();
+    } else if (name == "selectionset") {
+        WindowID id;
+        args >> id;
+        for (auto r = rows.first(); r != nullptr; r = r->next()) {
+            r->data()->selection_set(id);
+        }
+    } else if (name == "selectionreset") {
+        for (auto r = rows.first(); r != nullptr; r = r->next()) {
+            r->data()->selection_reset();
+        }
+    } else if (name == "selectionworkspace") {
+        if (auto s = row())
+            s->selection_all();
+    } else if (name == "selectionmove") {
+        args >> workspace;
+        Direction direction = read_enum<Direction>(args);
+        selection_move(workspace, direction);
+    } else if (name == "scroll") {
+        Row *s = row();
+        Direction direction = read_enum<Direction>(args);
+        Vector2D delta;
+        args >> delta.x >> delta.y;
+        if (s != nullptr)
+            s->scroll_update(direction, delta);
+    } else if (name == "scrollend") {
+        Row *s = row();
+        Direction direction = read_enum<Direction>(args);
+        if (s != nullptr)
+            s->scroll_end(direction);
+    } else if (name == "record") {
+        // A new recording starts with the windows already in the layout
+        clear();
+    } else if (name == "enable" || name == "disable" || name == "stop" || name == "jump" ||
+               name.starts_with("marks") || name.starts_with("trail")) {
+        // Nothing to do in the layout
+    } else {
+        unknown[name]++;
+    }
+}
+
+bool Replay::run(std::istream &input)
+{
+    std::string pending, line, name;
+    bool header = false;
+    auto run_pending = [&]() {
+        if (pending.empty())
+            return;
+        Args args(pending);
+        args >> name;
+        const auto start = std::chrono::steady_clock::now();
+        execute(name, args);
+        layout.flush_events();
+        const auto end = std::chrono::steady_clock::now();
+        timings[name].push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        layout.clear_events();
+        pending.clear();
+    };
+
+    while (std::getline(input, line)) {
+        if (line.empty())
+            continue;
+        Args args(line);
+        args >> name;
+        if (name == "record") {
+            int version = 0;
+            args >> version;
+            if (version != Recorder::VERSION) {
+                std::cerr << "unsupported record version " << version << std::endl;
+                return false;
+            }
+            header = true;
+        }
+        if (!apply_input(name, args)) {
+            // Inputs after an operation belong to it, run it when the next
+            // operation starts
+            run_pending();
+            pending = line;
+        }
+    }
+    run_pending();
+    if (!header)
+        std::cerr << "warning: no record header, is this a scroller:record file?" << std::endl;
+    return true;
+}
+
+void Replay::report_timings(std::ostream &output) const
+{
+    struct Line {
+        std::string name;
+        size_t count;
+        double total, p50, p99, max;
+    };
+    std::vector<Line> lines;
+    for (const auto &timing : timings) {
+        std::vector<double> times = timing.second;
+        std::sort(times.begin(), times.end());
+        double total = 0.0;
+        for (auto t : times)
+            total += t;
+        auto percentile = [&](double p) { return times[std::min(times.size() - 1, (size_t)(p * times.size()))]; };
+        lines.push_back({ timing.first, times.size(), total, percentile(0.5), percentile(0.99), times.back() });
+    }
+    std::sort(lines.begin(), lines.end(), [](const Line &a, const Line &b) { return a.total > b.total; });
+
+    output << std::left << std::setw(22) << "operation" << std::right << std::setw(8) << "count" <<
+        std::setw(12) << "total ms" << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" <<
+        std::setw(12) << "max us" << std::endl;
+    const auto precision = output.precision();
+    output << std::fixed << std::setprecision(1);
+    for (const auto &l : lines) {
+        output << std::left << std::setw(22) << l.name << std::right << std::setw(8) << l.count <<
+            std::setw(12) << l.total / 1000.0 << std::setw(12) << l.p50 << std::setw(12) << l.p99 <<
+            std::setw(12) << l.max << std::endl;
+    }
+    for (const auto &u : unknown) {
+        output << "unknown operation " << u.first << " (" << u.second << " times)" << std::endl;
+    }
+    output << std::defaultfloat << std::setprecision(precision);
+}
+
+// One line per window: workspace, window, committed position and size
+void Replay::report_geometry(std::ostream &output) const
+{
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        std::vector<WindowAdapter *> row_windows;
+        row->data()->get_windows(row_windows);
+        for (auto w : row_windows) {
+            const MockWindow *window = static_cast<MockWindow *>(w);
+            const Vector2D &position = window->get_committed_position();
+            const Vector2D &size = window->get_committed_size();
+            output << row->data()->get_workspace() << " " << window->get_id() << " " <<
+                position.x << " " << position.y << " " << size.x << " " << size.y << std::endl;
+        }
+    }
+}
+
+static void usage()
+{
+    std::cerr << "usage: hyprscroller-replay [--repeat N] [--geometry FILE] RECORD" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    int repeat = 1;
+    std::string geometry_path, record_path;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--geometry") == 0 && i + 1 < argc) {
+            geometry_path = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 1;
+        } else {
+            record_path = argv[i];
+        }
+    }
+    if (record_path.empty()) {
+        usage();
+        return 1;
+    }
+
+    // Each repetition starts from an empty layout, the report is for the last
+    // one (the others warm up caches and the allocator)
+    Replay *replay = nullptr;
+    for (int i = 0; i < repeat; ++i) {
+        std::ifstream input(record_path);
+        if (!input.is_open()) {
+            std::cerr << "cannot open " << record_path << std::endl;
+            return 1;
+        }
+        delete replay;
+        replay = new Replay();
+        if (!replay->run(input)) {
+            delete replay;
+            return 1;
+        }
+    }
+    replay->report_timings(std::cout);
+    if (!geometry_path.empty()) {
+        std::ofstream output(geometry_path);
+        replay->report_geometry(output);
+    } else {
+        std::cout << std::endl << "workspace window x y w h" << std::endl;
+        replay->report_geometry(std::cout);
+    }
+    delete replay;
+    return 0;
+}
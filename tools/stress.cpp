@@ -0,0 +1,912 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "marks.h"
+#include "mock.h"
+#include "row.h"
+#include "snapshot.h"
+
+// Randomised stress test for the layout core, on the mock adapters.
+//
+// Runs long random sequences of valid operations (the same ones
+// ScrollerLayout runs for each dispatcher or callback) on several monitors
+// and workspaces, and reports throughput, latency percentiles per operation
+// and peak memory. After every operation (or every --check operations), it
+// verifies the structure of rows, columns, marks and trails: active and
+// pinned nodes are part of their lists, every window in the layout is alive
+// and only in one place, and geometry is finite. On failure it prints the
+// seed and operation number to reproduce it.
+
+// Latency histogram with logarithmic buckets (~3% resolution), so millions
+// of samples don't need memory of their own.
+class Histogram {
+public:
+    Histogram() : count(0), total(0), max(0) {
+        std::fill(std::begin(counts), std::end(counts), 0);
+    }
+    void add(uint64_t ns) {
+        counts[bucket(ns)]++;
+        count++;
+        total += ns;
+        max = std::max(max, ns);
+    }
+    uint64_t get_count() const { return count; }
+    uint64_t get_total() const { return total; }
+    uint64_t get_max() const { return max; }
+    uint64_t percentile(double p) const {
+        const uint64_t rank = std::max<uint64_t>(1, std::ceil(p * count));
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            seen += counts[b];
+            if (seen >= rank)
+                return std::min(value(b), max);
+        }
+        return max;
+    }
+
+private:
+    static constexpr int SUB_BITS = 5;
+    static constexpr int SUB = 1 << SUB_BITS;
+    static constexpr int BUCKETS = 64 * SUB;
+
+    static int bucket(uint64_t ns) {
+        if (ns < SUB)
+            return ns;
+        const int e = std::bit_width(ns) - 1;
+        return (e - SUB_BITS + 1) * SUB + ((ns >> (e - SUB_BITS)) - SUB);
+    }
+    // Upper bound of the bucket
+    static uint64_t value(int b) {
+        if (b < SUB)
+            return b;
+        const int e = b / SUB + SUB_BITS - 1;
+        const uint64_t m = b % SUB;
+        return ((SUB + m + 1) << (e - SUB_BITS)) - 1;
+    }
+
+    uint64_t counts[BUCKETS];
+    uint64_t count, total, max;
+};
+
+enum class Op {
+    Open, Close, Focus, SwitchWorkspace, MoveToWorkspace, MoveFocus, MoveWindow, AlignWindow,
+    AdmitWindow, ExpelWindow, SetMode, Pin, CycleSize, FitSize, ToggleOverview,
+    Swipe, Gaps, SelectionToggle, SelectionWorkspace, SelectionMove,
+    MarksAdd, MarksDelete, MarksVisit, TrailNew, TrailNext, TrailPrevious,
+    TrailDelete, TrailClear, TrailToSelection, TrailmarkToggle, TrailmarkNext,
+    TrailmarkPrevious, Snapshot, Storm,
+    Count
+};
+
+static const struct {
+    const char *name;
+    double weight;
+} operations[] = {
+    { "open", 12.0 },
+    { "close", 8.0 },
+    { "focus", 6.0 },
+    { "switchworkspace", 3.0 },
+    { "movetoworkspace", 2.0 },
+    { "movefocus", 12.0 },
+    { "movewindow", 8.0 },
+    { "alignwindow", 2.0 },
+    { "admitwindow", 4.0 },
+    { "expelwindow", 4.0 },
+    { "setmode", 2.0 },
+    { "pin", 1.5 },
+    { "cyclesize", 4.0 },
+    { "fitsize", 2.0 },
+    { "toggleoverview", 2.0 },
+    { "swipe", 2.0 },
+    { "gaps", 0.5 },
+    { "selectiontoggle", 3.0 },
+    { "selectionworkspace", 0.5 },
+    { "selectionmove", 1.5 },
+    { "marksadd", 1.5 },
+    { "marksdelete", 0.5 },
+    { "marksvisit", 1.5 },
+    { "trailnew", 0.5 },
+    { "trailnext", 0.5 },
+    { "trailprevious", 0.5 },
+    { "traildelete", 0.3 },
+    { "trailclear", 0.2 },
+    { "trailtoselection", 0.3 },
+    { "trailmarktoggle", 1.5 },
+    { "trailmarknext", 1.0 },
+    { "trailmarkprevious", 1.0 },
+    { "snapshot", 0.3 },
+    { "storm", 0.3 },
+};
+static_assert(sizeof(operations) / sizeof(operations[0]) == (size_t)Op::Count);
+
+static const struct {
+    const char *name;
+    Box full;
+} monitor_table[] = {
+    { "DP-1", Box(0, 0, 2560, 1440) },
+    { "HDMI-A-1", Box(2560, 0, 1920, 1080) },
+    { "DP-2", Box(-1440, 0, 1440, 2560) },
+    { "eDP-1", Box(0, 1440, 1366, 768) },
+};
+static const int max_monitors = sizeof(monitor_table) / sizeof(monitor_table[0]);
+
+class Stress {
+public:
+    Stress(uint64_t seed, int nmonitors, int nworkspaces, size_t max_windows);
+    ~Stress();
+
+    // Returns false if an invariant is broken
+    bool run(uint64_t count, uint64_t check_every);
+    void report(std::ostream &output, double seconds) const;
+
+private:
+    template <typename T>
+    T pick(T n) { return std::uniform_int_distribution<T>(0, n - 1)(rng); }
+    bool coin() { return pick(2) == 1; }
+    Direction pick_direction(bool align = false);
+
+    MonitorID get_monitor(WorkspaceID workspace) const { return (workspace - 1) % nmonitors; }
+    void switch_workspace(WorkspaceID ws);
+    Row *get_row(WorkspaceID ws) const;
+    Row *get_row_for_window(WindowID window) const;
+    Row *current_row() const { return get_row(workspace); }
+    WindowID active_window() const;
+    MockWindow *random_window();
+    void focus(WindowID window);
+    void delete_row(Row *row);
+    void start_timer() { timer = std::chrono::steady_clock::now(); }
+
+    void execute(Op op);
+    void open();
+    void close();
+    void move_to_workspace();
+    void storm();
+    void selection_move(Direction direction);
+    void snapshot();
+    std::string check() const;
+
+    std::mt19937_64 rng;
+    std::discrete_distribution<int> choose;
+    int nmonitors;
+    int nworkspaces;
+    size_t max_windows;
+    MockLayout layout;
+    List<Row *> rows;
+    std::vector<MockWindow *> windows;
+    Marks *marks;
+    Trails *trails;
+    WorkspaceID workspace;
+    // Workspace shown on each monitor
+    std::vector<WorkspaceID> shown;
+    WindowID next_id;
+    size_t peak_windows;
+    std::chrono::steady_clock::time_point timer;
+    Histogram histograms[(int)Op::Count];
+    // Set when a snapshot doesn't survive its round trip
+    std::string snapshot_error;
+    // Set when focusing a window without a full layout leaves the row
+    // different from what the full layout does
+    std::string focus_error;
+    bool checking = false;
+};
+
+Stress::Stress(uint64_t seed, int nmonitors, int nworkspaces, size_t max_windows)
+    : rng(seed), nmonitors(nmonitors), nworkspaces(nworkspaces), max_windows(max_windows),
+      workspace(1), next_id(1), peak_windows(0)
+{
+    std::vector<double> weights;
+    for (const auto &operation : operations) {
+        weights.push_back(operation.weight);
+    }
+    choose = std::discrete_distribution<int>(weights.begin(), weights.end());
+
+    for (int m = 0; m < nmonitors; ++m) {
+        layout.add_monitor(monitor_table[m].name, monitor_table[m].full);
+    }
+    layout.set_gaps(5, 20);
+    // Portrait monitor in column mode, with its own sizes
+    layout.set_sizes("one", "onehalf", "onethird onehalf twothirds one", "onethird onehalf twothirds one",
+                     "(DP-2 = (mode = col; column_default_width = one; window_default_height = onehalf))", true);
+    marks = new Marks(&layout);
+    trails = new Trails(&layout);
+    for (int m = 0; m < nmonitors; ++m) {
+        shown.push_back(m + 1);
+    }
+    for (WorkspaceID ws = 1; ws <= nworkspaces; ++ws) {
+        layout.set_workspace(ws, get_monitor(ws), ws <= nmonitors);
+    }
+    switch_workspace(1);
+}
+
+Stress::~Stress()
+{
+    delete marks;
+    delete trails;
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        delete row->data();
+    }
+    rows.clear();
+    for (auto window : windows) {
+        delete window;
+    }
+}
+
+Direction Stress::pick_direction(bool align)
+{
+    static const Direction move[] = { Direction::Left, Direction::Right, Direction::Up, Direction::Down,
+                                      Direction::Begin, Direction::End };
+    static const Direction aligns[] = { Direction::Left, Direction::Right, Direction::Up, Direction::Down,
+                                        Direction::Center, Direction::Middle };
+    return align ? aligns[pick(6)] : move[pick(6)];
+}
+
+// Like recalculateMonitor() when the workspace is shown, laying out the row
+// if it changed while hidden
+void Stress::switch_workspace(WorkspaceID ws)
+{
+    workspace = ws;
+    const MonitorID monitor = get_monitor(ws);
+    layout.set_active_monitor(monitor);
+    layout.set_workspace(shown[monitor], monitor, false);
+    layout.set_workspace(ws, monitor, true);
+    shown[monitor] = ws;
+    Row *s = current_row();
+    if (s != nullptr && s->is_stale()) {
+        const Box oldmax = s->get_max();
+        const bool force = s->update_sizes(get_monitor(ws));
+        s->update_windows(oldmax, force);
+    }
+}
+
+Row *Stress::get_row(WorkspaceID ws) const
+{
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        if (row->data()->get_workspace() == ws)
+            return row->data();
+    }
+    return nullptr;
+}
+
+Row *Stress::get_row_for_window(WindowID window) const
+{
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        if (row->data()->has_window(window))
+            return row->data();
+    }
+    return nullptr;
+}
+
+WindowID Stress::active_window() const
+{
+    const Row *s = current_row();
+    return s != nullptr ? s->get_active_window()->get_id() : 0;
+}
+
+MockWindow *Stress::random_window()
+{
+    return windows.empty() ? nullptr : windows[pick(windows.size())];
+}
+
+// What the compositor does when focusing a window: switch to its workspace
+// and tell the layout. Some focus changes come from the pointer within
+// focus_hover_ms of the last scroll, and don't scroll.
+void Stress::focus(WindowID window)
+{
+    Row *s = get_row_for_window(window);
+    if (s == nullptr)
+        return;
+    switch_workspace(s->get_workspace());
+    const bool scroll = pick(4) != 0;
+    if (s->focus_window(window, scroll) || !scroll || !checking || s->is_stale())
+        return;
+
+    // It didn't lay out the row, so a full layout must leave every column
+    // where it is. Columns lay out their windows vertically again on every
+    // call, so only the horizontal geometry is comparable.
+    std::vector<WindowAdapter *> row_windows;
+    s->get_windows(row_windows);
+    std::vector<std::pair<double, double>> before;
+    for (auto w : row_windows) {
+        const MockWindow *mw = static_cast<const MockWindow *>(w);
+        before.push_back({ mw->get_committed_position().x, mw->get_committed_size().x });
+    }
+    s->recalculate_row_geometry();
+    for (size_t i = 0; i < row_windows.size(); ++i) {
+        const MockWindow *mw = static_cast<const MockWindow *>(row_windows[i]);
+        const double x = mw->get_committed_position().x, w = mw->get_committed_size().x;
+        if (std::abs(x - before[i].first) > 1e-6 || std::abs(w - before[i].second) > 1e-6) {
+            focus_error = std::format("workspace {}: focusing window {} without a layout left window {} at x {} "
+                                      "w {}, the layout puts it at x {} w {}", s->get_workspace(), window,
+                                      mw->get_id(), before[i].first, before[i].second, x, w);
+            return;
+        }
+    }
+}
+
+void Stress::delete_row(Row *r)
+{
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        if (row->data() == r) {
+            rows.erase(row);
+            delete r;
+            return;
+        }
+    }
+}
+
+void Stress::open()
+{
+    if (windows.size() >= max_windows) {
+        close();
+        return;
+    }
+    MockWindow *window = new MockWindow(next_id++, monitor_table[get_monitor(workspace)].name, 2.0);
+    windows.push_back(window);
+    start_timer();
+    Row *s = current_row();
+    if (s == nullptr) {
+        s = new Row(workspace, &layout);
+        rows.push_back(s);
+    }
+    s->add_active_window(window);
+}
+
+void Stress::close()
+{
+    MockWindow *window = random_window();
+    if (window == nullptr)
+        return;
+    const WindowID id = window->get_id();
+    start_timer();
+    Row *s = get_row_for_window(id);
+    marks->remove(id);
+    trails->remove_window(id);
+    if (s != nullptr && !s->remove_window(id))
+        delete_row(s);
+    windows.erase(std::find(windows.begin(), windows.end(), window));
+    delete window;
+}
+
+// Hyprland's movetoworkspacesilent: ScrollerLayout keeps the Window
+void Stress::move_to_workspace()
+{
+    MockWindow *window = random_window();
+    if (window == nullptr)
+        return;
+    const WindowID id = window->get_id();
+    Row *from = get_row_for_window(id);
+    if (from == nullptr || nworkspaces < 2)
+        return;
+    WorkspaceID to = 1 + pick(nworkspaces - 1);
+    if (to >= from->get_workspace())
+        ++to;
+    start_timer();
+    Window *moved = from->detach_window(id);
+    if (from->size() == 0)
+        delete_row(from);
+    Row *s = get_row(to);
+    if (s == nullptr) {
+        s = new Row(to, &layout);
+        rows.push_back(s);
+    }
+    s->attach_window(moved);
+}
+
+// An application opening and closing windows at once, with defer_layout:
+// the row only changes its structure, and is laid out once at the end
+void Stress::storm()
+{
+    Row *s = current_row();
+    if (s == nullptr || s->is_overview())
+        return;
+    const WorkspaceID ws = workspace;
+    start_timer();
+    s->begin_load();
+    for (int n = 1 + pick(20); n > 0; --n) {
+        if (coin() || windows.size() >= max_windows) {
+            MockWindow *window = random_window();
+            if (window == nullptr || get_row_for_window(window->get_id()) != s)
+                continue;
+            const WindowID id = window->get_id();
+            marks->remove(id);
+            trails->remove_window(id);
+            const bool last = !s->remove_window(id);
+            windows.erase(std::find(windows.begin(), windows.end(), window));
+            delete window;
+            if (last) {
+                delete_row(s);
+                return;
+            }
+        } else {
+            MockWindow *window = new MockWindow(next_id++, monitor_table[get_monitor(ws)].name, 2.0);
+            windows.push_back(window);
+            s->add_active_window(window);
+        }
+    }
+    s->end_load(true);
+}
+
+// Same as ScrollerLayout::selection_move()
+void Stress::selection_move(Direction direction)
+{
+    bool selection = false;
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        if (row->data()->selection_exists()) {
+            selection = true;
+            break;
+        }
+    }
+    if (!selection)
+        return;
+
+    auto s = current_row();
+    bool overview_on = false;
+    if (s == nullptr) {
+        s = new Row(workspace, &layout);
+        rows.push_back(s);
+    } else {
+        overview_on = s->is_overview();
+        if (overview_on)
+            s->toggle_overview();
+    }
+    List<Column *> columns;
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        if (row->data()->size() > 0)
+            row->data()->selection_get(s, columns);
+    }
+    s->selection_move(columns, direction);
+
+    auto row = rows.first();
+    while (row != nullptr) {
+        auto next = row->next();
+        if (row->data()->size() == 0) {
+            delete row->data();
+            rows.erase(row);
+        } else {
+            bool overview = row->data()->is_overview();
+            if (overview)
+                row->data()->toggle_overview();
+            row->data()->recalculate_row_geometry();
+            if (overview)
+                row->data()->toggle_overview();
+        }
+        row = next;
+    }
+    for (auto r = rows.first(); r != nullptr; r = r->next()) {
+        r->data()->selection_reset();
+    }
+    if (overview_on)
+        s->toggle_overview();
+}
+
+void Stress::execute(Op op)
+{
+    Row *s = current_row();
+    switch (op) {
+    case Op::Open:
+        open();
+        break;
+    case Op::Close:
+        close();
+        break;
+    case Op::Focus:
+        if (auto window = random_window())
+            focus(window->get_id());
+        break;
+    case Op::MoveToWorkspace:
+        move_to_workspace();
+        break;
+    case Op::SwitchWorkspace:
+        switch_workspace(1 + pick(nworkspaces));
+        if (auto row = current_row()) {
+            row->post_event(EventTopic::Mode);
+            row->post_event(EventTopic::Overview);
+        }
+        break;
+    case Op::MoveFocus:
+        if (s != nullptr)
+            s->move_focus(pick_direction(), coin());
+        break;
+    case Op::MoveWindow:
+        if (s != nullptr) {
+            const Direction direction = pick_direction();
+            if (coin())
+                s->move_active_window(direction);
+            else
+                s->move_active_column(direction);
+        }
+        break;
+    case Op::AlignWindow:
+        if (s != nullptr)
+            s->align_column(pick_direction(true));
+        break;
+    case Op::AdmitWindow:
+        if (s != nullptr)
+            s->admit_window(coin() ? AdmitExpelDirection::Left : AdmitExpelDirection::Right);
+        break;
+    case Op::ExpelWindow:
+        if (s != nullptr)
+            s->expel_window(coin() ? AdmitExpelDirection::Left : AdmitExpelDirection::Right);
+        break;
+    case Op::SetMode:
+        if (s != nullptr)
+            s->set_mode(coin() ? Mode::Row : Mode::Column);
+        break;
+    case Op::Pin:
+        if (s != nullptr)
+            s->pin();
+        break;
+    case Op::CycleSize:
+        if (s != nullptr) {
+            // cyclesize, cyclewidth or cycleheight
+            const int which = pick(3);
+            const int step = coin() ? 1 : -1;
+            const Mode mode = s->get_mode();
+            if (which > 0)
+                s->set_mode(which == 1 ? Mode::Row : Mode::Column, true);
+            s->resize_active_column(step);
+            s->set_mode(mode, true);
+        }
+        break;
+    case Op::FitSize:
+        if (s != nullptr)
+            s->fit_size(static_cast<FitSize>(pick(5)));
+        break;
+    case Op::ToggleOverview:
+        if (s != nullptr)
+            s->toggle_overview();
+        break;
+    case Op::Swipe:
+        if (s != nullptr) {
+            const Direction direction = coin() ? Direction::Left : Direction::Right;
+            const Vector2D delta(std::uniform_real_distribution<double>(-200.0, 200.0)(rng), 0.0);
+            start_timer();
+            s->scroll_update(direction, delta);
+            s->scroll_end(direction);
+        }
+        break;
+    case Op::Gaps: {
+        // Changes every viewport, like a configuration reload
+        layout.set_gaps(pick(15), pick(40));
+        start_timer();
+        for (auto row = rows.first(); row != nullptr; row = row->next()) {
+            const Box oldmax = row->data()->get_max();
+            const bool force = row->data()->update_sizes(get_monitor(row->data()->get_workspace()));
+            row->data()->update_windows(oldmax, force);
+        }
+        break;
+    }
+    case Op::SelectionToggle:
+        if (s != nullptr)
+            s->selection_toggle();
+        break;
+    case Op::SelectionWorkspace:
+        if (s != nullptr)
+            s->selection_all();
+        break;
+    case Op::SelectionMove:
+        // Usually to another workspace
+        switch_workspace(1 + pick(nworkspaces));
+        selection_move(coin() ? Direction::End : pick_direction());
+        break;
+    case Op::MarksAdd:
+        if (s != nullptr)
+            marks->add(active_window(), std::string(1, 'a' + pick(6)));
+        break;
+    case Op::MarksDelete:
+        marks->del(std::string(1, 'a' + pick(6)), active_window());
+        break;
+    case Op::MarksVisit:
+        focus(marks->visit(std::string(1, 'a' + pick(6))));
+        break;
+    case Op::TrailNew:
+        trails->trail_new();
+        break;
+    case Op::TrailNext:
+        trails->trail_next();
+        break;
+    case Op::TrailPrevious:
+        trails->trail_prev();
+        break;
+    case Op::TrailDelete:
+        trails->trail_delete();
+        break;
+    case Op::TrailClear:
+        trails->trail_clear();
+        break;
+    case Op::TrailToSelection: {
+        std::vector<WindowID> trail;
+        trails->get_active_windows(trail);
+        for (auto window : trail) {
+            for (auto row = rows.first(); row != nullptr; row = row->next()) {
+                row->data()->selection_set(window);
+            }
+        }
+        break;
+    }
+    case Op::TrailmarkToggle:
+        if (s != nullptr)
+            trails->trailmark_toggle(active_window());
+        break;
+    case Op::TrailmarkNext:
+        trails->trailmark_next();
+        focus(trails->get_active());
+        break;
+    case Op::TrailmarkPrevious:
+        trails->trailmark_prev();
+        focus(trails->get_active());
+        break;
+    case Op::Storm:
+        storm();
+        break;
+    case Op::Snapshot:
+        snapshot();
+        break;
+    case Op::Count:
+        break;
+    }
+}
+
+// Sorts the columns of rows with a pinned column by their first window
+static void canonical(::Snapshot &snapshot)
+{
+    for (auto &row : snapshot.rows) {
+        if (row.pinned < 0)
+            continue;
+        auto first = [](const SnapshotColumn &column) { return column.windows.front().key.id; };
+        const WindowID active = row.active >= 0 ? first(row.columns[row.active]) : 0;
+        const WindowID pinned = first(row.columns[row.pinned]);
+        std::sort(row.columns.begin(), row.columns.end(), [&](const SnapshotColumn &a, const SnapshotColumn &b) {
+            return first(a) < first(b);
+        });
+        for (int32_t c = 0; c < static_cast<int32_t>(row.columns.size()); ++c) {
+            if (first(row.columns[c]) == active)
+                row.active = c;
+            if (first(row.columns[c]) == pinned)
+                row.pinned = c;
+        }
+    }
+}
+
+// Saves the layout, reads it back and restores it with the same windows,
+// like reloading the plugin. The layout must be the same afterwards.
+void Stress::snapshot()
+{
+    ::Snapshot saved;
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        row->data()->save(saved.rows.emplace_back());
+    }
+    marks->save(saved.marks);
+    trails->save(saved);
+    std::string data;
+    saved.serialize(data);
+
+    ::Snapshot read;
+    std::string again;
+    if (!read.deserialize(data)) {
+        snapshot_error = "snapshot: cannot read a snapshot back";
+        return;
+    }
+    read.serialize(again);
+    if (again != data) {
+        snapshot_error = "snapshot: different after reading it back";
+        return;
+    }
+
+    std::unordered_map<WindowID, WindowID> ids;
+    for (auto window : windows) {
+        ids[window->get_id()] = window->get_id();
+    }
+    size_t index = 0;
+    for (auto row = rows.first(); row != nullptr; row = row->next(), ++index) {
+        row->data()->restore(read.rows[index], ids);
+    }
+    marks->restore(read.marks, ids);
+    trails->restore(read, ids);
+
+    ::Snapshot restored;
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        row->data()->save(restored.rows.emplace_back());
+    }
+    marks->save(restored.marks);
+    trails->save(restored);
+    restored.serialize(again);
+    // Restoring a row with a pinned column can move the active column next
+    // to it, like any other relayout, so their order is not compared
+    canonical(read);
+    canonical(restored);
+    read.serialize(data);
+    restored.serialize(again);
+    if (again != data)
+        snapshot_error = "snapshot: the layout changed after restoring it";
+}
+
+std::string Stress::check() const
+{
+    if (!snapshot_error.empty())
+        return snapshot_error;
+    if (!focus_error.empty())
+        return focus_error;
+    size_t nwindows = 0;
+    for (auto row = rows.first(); row != nullptr; row = row->next()) {
+        const Row *s = row->data();
+        if (s->size() == 0)
+            return std::format("workspace {}: empty row", s->get_workspace());
+        for (auto other = row->next(); other != nullptr; other = other->next()) {
+            if (other->data()->get_workspace() == s->get_workspace())
+                return std::format("workspace {}: two rows", s->get_workspace());
+        }
+        std::string error = s->check();
+        if (!error.empty())
+            return error;
+        if (s->is_stale() && layout.is_workspace_visible(s->get_workspace()))
+            return std::format("workspace {}: stale row is visible", s->get_workspace());
+        std::vector<WindowAdapter *> row_windows;
+        const_cast<Row *>(s)->get_windows(row_windows);
+        for (auto w : row_windows) {
+            if (std::find(windows.begin(), windows.end(), w) == windows.end())
+                return std::format("workspace {}: window {} is not alive", s->get_workspace(), w->get_id());
+            const MockWindow *window = static_cast<const MockWindow *>(w);
+            const Vector2D &position = window->get_committed_position();
+            const Vector2D &size = window->get_committed_size();
+            if (!std::isfinite(position.x) || !std::isfinite(position.y) ||
+                !std::isfinite(size.x) || !std::isfinite(size.y))
+                return std::format("workspace {}: window {} has invalid geometry", s->get_workspace(), w->get_id());
+        }
+        nwindows += row_windows.size();
+    }
+    if (nwindows != windows.size())
+        return std::format("{} windows in the layout, {} alive", nwindows, windows.size());
+
+    auto alive = [&](WindowID id) {
+        for (auto window : windows) {
+            if (window->get_id() == id)
+                return true;
+        }
+        return false;
+    };
+    std::string error = marks->check();
+    if (!error.empty())
+        return error;
+    std::vector<WindowID> marked;
+    marks->get_windows(marked);
+    for (auto id : marked) {
+        if (!alive(id))
+            return std::format("mark of window {}, which is not alive", id);
+    }
+    error = trails->check();
+    if (!error.empty())
+        return error;
+    marked.clear();
+    trails->get_windows(marked);
+    for (auto id : marked) {
+        if (!alive(id))
+            return std::format("trailmark of window {}, which is not alive", id);
+    }
+    return "";
+}
+
+bool Stress::run(uint64_t count, uint64_t check_every)
+{
+    checking = check_every > 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        const Op op = static_cast<Op>(choose(rng));
+        start_timer();
+        execute(op);
+        layout.flush_events();
+        const auto end = std::chrono::steady_clock::now();
+        histograms[(int)op].add(std::chrono::duration_cast<std::chrono::nanoseconds>(end - timer).count());
+        layout.clear_events();
+        peak_windows = std::max(peak_windows, windows.size());
+
+        if (check_every > 0 && (i + 1) % check_every == 0) {
+            const std::string error = check();
+            if (!error.empty()) {
+                std::cerr << "operation " << i + 1 << " (" << operations[(int)op].name << "): " << error << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Stress::report(std::ostream &output, double seconds) const
+{
+    // Throughput only counts the time spent in the operations, not the checks
+    uint64_t total = 0, ns = 0;
+    for (const auto &histogram : histograms) {
+        total += histogram.get_count();
+        ns += histogram.get_total();
+    }
+    output << total << " operations in " << std::fixed << std::setprecision(2) << ns / 1e9 << " s (" <<
+        seconds << " s with checks), " << std::setprecision(0) << total / (ns / 1e9) << " operations/s" <<
+        std::endl << std::endl;
+
+    std::vector<int> order;
+    for (int op = 0; op < (int)Op::Count; ++op) {
+        if (histograms[op].get_count() > 0)
+            order.push_back(op);
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return histograms[a].get_total() > histograms[b].get_total();
+    });
+    output << std::left << std::setw(22) << "operation" << std::right << std::setw(10) << "count" <<
+        std::setw(12) << "total ms" << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" <<
+        std::setw(12) << "max us" << std::endl;
+    for (auto op : order) {
+        const Histogram &h = histograms[op];
+        output << std::left << std::setw(22) << operations[op].name << std::right << std::setw(10) << h.get_count() <<
+            std::setprecision(1) << std::setw(12) << h.get_total() / 1e6 << std::setw(12) << h.percentile(0.5) / 1e3 <<
+            std::setw(12) << h.percentile(0.99) / 1e3 << std::setw(12) << h.get_max() / 1e3 << std::endl;
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    output << std::endl << "peak memory: " << std::setprecision(1) << usage.ru_maxrss / 1024.0 << " MiB, peak windows: " <<
+        peak_windows << std::endl;
+    output << std::defaultfloat;
+}
+
+static void usage()
+{
+    std::cerr << "usage: hyprscroller-stress [--seed N] [--operations N] [--monitors N] [--workspaces N]" << std::endl <<
+        "                           [--windows N] [--check N]" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t seed = std::random_device()();
+    uint64_t count = 1000000;
+    uint64_t check_every = 1;
+    int nmonitors = 3;
+    int nworkspaces = 6;
+    size_t max_windows = 200;
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        if (strcmp(argv[i], "--seed") == 0) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--operations") == 0) {
+            count = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--monitors") == 0) {
+            nmonitors = std::clamp(atoi(argv[++i]), 1, max_monitors);
+        } else if (strcmp(argv[i], "--workspaces") == 0) {
+            nworkspaces = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--windows") == 0) {
+            max_windows = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--check") == 0) {
+            check_every = strtoull(argv[++i], nullptr, 10);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::cout << "seed " << seed << std::endl;
+    Stress *stress = new Stress(seed, nmonitors, nworkspaces, max_windows);
+    const auto start = std::chrono::steady_clock::now();
+    const bool ok = stress->run(count, check_every);
+    const auto end = std::chrono::steady_clock::now();
+    if (!ok) {
+        // The layout is broken, don't try to delete it
+        std::cerr << "invariant broken, reproduce with --seed " << seed << std::endl;
+        return 1;
+    }
+    stress->report(std::cout, std::chrono::duration<double>(end - start).count());
+    delete stress;
+    return 0;
+}